@@ -5,35 +5,19 @@
 #include "SpriteSystem.h"
 #include "PhysicsSystem.h"
 
-class Particle : public decs::Component
+class Particle : public decs::PodComponent<Particle>
 {
 public:
-    Particle();
-    ~Particle();
-
-    PositionSystem positionSystem;
-    PhysicsSystem physicsSystem;
-    SpriteSystem spriteSystem;
+    static PositionSystem positionSystem;
+    static PhysicsSystem physicsSystem;
+    static SpriteSystem spriteSystem;
 
     static sf::Vector2f emitter;
 
-    void initialise() override 
+    void initialise()
     {  
-        // give a random velocity and lifetime to the particle
+        // give a random lifetime to the particle, ParticleSystem::SpawnCreated adds the other components
         lifetime = (1.0f + 1) + (((float)rand()) / (float)RAND_MAX) * (2.0f - (1.0f + 1));
-
-        positionSystem.addComponentWithID(belongsTo);
-        positionSystem.getComponentWithID(belongsTo).position = emitter;
-
-        spriteSystem.addComponentWithID(belongsTo);
-        physicsSystem.addComponentWithID(belongsTo);
-
-
-        float angle = (std::rand() % 360) * 3.14f / 180.f;
-        float speed = (std::rand() % 500) + 300;
-        physicsSystem.getComponentWithID(belongsTo).velocity = 
-            sf::Vector2f(std::cos(angle) * speed, std::sin(angle) * speed);
-        
     }
 
     float lifetime;
@@ -41,7 +25,7 @@ public:
 
     static sf::Time elapsed;
 
-    void update() override
+    void update()
     {
         lifetime -= decs::World::getDeltaTime();
 
@@ -50,20 +34,15 @@ public:
             decs::World::destroyEntity(belongsTo, true);
             return;
         }
-        if (isActive() == false)
-        {
-            decs::World::destroyEntity(belongsTo, true);
-            return;
-        }
 
         // Check particle out of bounds
-        PositionComponent* pc = positionSystem.getPtrComponentWithID(belongsTo);
-        if (pc->position.x < 0 || pc->position.x > 800)
+        const PositionComponent& pc = positionSystem.readComponentWithID(belongsTo);
+        if (pc.position.x < 0 || pc.position.x > 800)
         {
             decs::World::destroyEntity(belongsToID(), true);
             return;
         }
-        if (pc->position.y > 600)
+        if (pc.position.y > 600)
         {
             decs::World::destroyEntity(belongsToID(), true);
             return;
@@ -72,13 +51,7 @@ public:
 
 };
 
-Particle::Particle()
-{
-
-}
-
-Particle::~Particle()
-{
-}
-
+PositionSystem Particle::positionSystem;
+PhysicsSystem Particle::physicsSystem;
+SpriteSystem Particle::spriteSystem;
 sf::Vector2f Particle::emitter;
\ No newline at end of file
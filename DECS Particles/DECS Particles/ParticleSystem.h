@@ -29,11 +29,34 @@ public:
         }
 
         Particle::emitter = emitter;
-        for (int i = 0; i < amount; i++)
+        decs::Vector<int> entIDs = decs::World::createNewIDs(amount);
+        this->addComponentsWithIDs(entIDs);
+    }
+
+    // Gives every particle created since the last call its position, sprite and physics
+    // components in one batch per system. Called once per frame.
+    void SpawnCreated()
+    {
+        decs::IDSet& created = getAddedIDs();
+        if (created.empty())
+        {
+            return;
+        }
+
+        Particle::positionSystem.addComponentsWithIDs(created.data(), created.size());
+        Particle::spriteSystem.addComponentsWithIDs(created.data(), created.size());
+        Particle::physicsSystem.addComponentsWithIDs(created.data(), created.size());
+
+        for (int id : created)
         {
-            int entID = decs::World::createNewID();
-            this->addComponentWithID(entID);
+            Particle::positionSystem.getComponentWithID(id).position = Particle::emitter;
+
+            float angle = (std::rand() % 360) * 3.14f / 180.f;
+            float speed = (std::rand() % 500) + 300;
+            Particle::physicsSystem.getComponentWithID(id).velocity =
+                sf::Vector2f(std::cos(angle) * speed, std::sin(angle) * speed);
         }
+        created.clear();
     }
 
 private:
@@ -42,7 +65,7 @@ private:
 
 ParticleSystem::ParticleSystem()
 {
-
+    setObserving(true);
 }
 
 ParticleSystem::~ParticleSystem()
@@ -3,20 +3,23 @@
 #include <SFML/Graphics.hpp>
 
 const float GRAVITY = 9.8f;
-class PhysicsComponent : public decs::Component
+class PhysicsComponent : public decs::PodComponent<PhysicsComponent>
 {
 public:
 	sf::Vector2f velocity;
 	float gravityScale;
 
-	void initialise() override
+	// Physics update only touches these two fields, store each in its own array.
+	using Storage = decs::SoAStorage<PhysicsComponent, &PhysicsComponent::velocity, &PhysicsComponent::gravityScale>;
+
+	void initialise()
 	{
 		velocity = { 0, 0};
 		gravityScale = 200.0f;
 	}
 
 
-	void update() override
+	void update()
 	{
 		velocity.y += (GRAVITY * gravityScale * decs::World::getDeltaTime());
 	}
@@ -4,22 +4,23 @@
 #include <iostream>
 #include "PhysicsSystem.h"
 
-class PositionComponent : public decs::Component
+class PositionComponent : public decs::PodComponent<PositionComponent>
 {
 public:
-	PositionComponent() {  };
-	~PositionComponent() {  };
-	PhysicsSystem physicsSystem;
+	static PhysicsSystem physicsSystem;
 	sf::Vector2f position;
 
-	void initialise() override 
+	void initialise()
 	{
 		position = { 0, 0 };
 	};
 
-	void update() override
+	void update()
 	{
-		position += physicsSystem.getComponentWithID(belongsTo).velocity * decs::World::getDeltaTime();
+		// Only reads, so it stays inside readsComponents<PhysicsComponent>() and writes no Reference back.
+		position += physicsSystem.readComponentWithID(belongsTo).velocity * decs::World::getDeltaTime();
 	}
 
-};
\ No newline at end of file
+};
+
+PhysicsSystem PositionComponent::physicsSystem;
\ No newline at end of file
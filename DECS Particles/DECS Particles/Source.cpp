@@ -23,6 +23,17 @@ int main()
     SpriteSystem spriteSystem;
     spriteSystem.setCanUpdate(false);
 
+    // Keeps the components of each particle at the same position in every dense list,
+    // so position updates and drawing walk the lists in step.
+    decs::Group<PositionComponent, PhysicsComponent, SpriteComponent> particleGroup;
+
+    // Declaring what each update touches lets World run systems that don't conflict in parallel.
+    // Conflicting systems still run in the declaration order above.
+    phys.readsComponents<>();
+    pos.readsComponents<PhysicsComponent>();
+    particleSystem.readsComponents<PositionComponent>();
+    decs::World::setThreadCount(std::thread::hardware_concurrency());
+
 
     sf::Font font;
     if (!font.loadFromFile("pressStart.ttf"))
@@ -96,6 +107,7 @@ int main()
         sf::Time elapsed = clock.restart();
 
         // update it
+        particleSystem.SpawnCreated();
         decs::World::setDeltaTime(elapsed.asSeconds());
         decs::World::update();
 
@@ -10,17 +10,10 @@ public:
 
 	void draw(sf::RenderTarget& target)
 	{
-		std::vector<SpriteComponent>& list = getDenseList();
-		for (int i = 0; i < getNumberOfActiveComponents(); i++)
+		decs::View<SpriteComponent, PositionComponent>().each([&target](int id, SpriteComponent& spr, PositionComponent& pos)
 		{
-			if (list[i].isActive() == false)
-			{
-				continue;
-			}
-
-			SpriteComponent& spr = list[i];
-			spr.sprite.setPosition(positionSystem.getComponentWithID(spr.belongsToID()).position);
+			spr.sprite.setPosition(pos.position);
 			target.draw(spr.sprite);
-		}
+		});
 	}
 };
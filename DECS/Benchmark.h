@@ -0,0 +1,633 @@
+#pragma once
+#include "dcs.h"
+#include "Instrumentation.h"
+#include "Timer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Size of one benchmark configuration.
+/// </summary>
+struct BenchmarkConfig
+{
+	int components = 100000;
+	int componentsPerID = 1;
+	int repetitions = 0;
+	int threads = 0;
+};
+
+/// <summary>
+/// Samples of one phase of one configuration, times in nanoseconds. min, max and mean are of whole
+/// repetitions. The percentiles are of the latency samples, nanoseconds per operation of every batch
+/// of consecutive operations, and are -1 when there are too few samples to differ from the slowest.
+/// </summary>
+struct BenchmarkResult
+{
+	std::string component;
+	int componentSize = 0;
+	BenchmarkConfig config;
+	std::string phase;
+	long long operations = 0;
+	int repetitions = 0;
+	double nsPerOp = 0;
+	long long min = 0;
+	int latencySamples = 0;
+	double p50 = 0;
+	double p90 = 0;
+	double p99 = 0;
+	long long max = 0;
+	long long mean = 0;
+
+	/// <summary>
+	/// True if the phase ran with instrumentation. The values below are then per operation
+	/// averaged over the repetitions, a counter the kernel refused is -1.
+	/// </summary>
+	bool instrumented = false;
+	double counters[PerfCounters::EventCount] = { -1, -1, -1, -1 };
+	double allocations = 0;
+	double allocatedBytes = 0;
+};
+
+/// <summary>
+/// Timer of one phase that also totals hardware counters and allocations over its samples
+/// when given PerfCounters. Counters are started before and read after the timed region.
+/// 
+/// Inside the timed region the phase reports its operations with Count. Every time at least
+/// batchOperations have been counted the time since the previous batch divided by their number
+/// is kept as a latency sample, so the latency percentiles cover every batch of every repetition.
+/// </summary>
+class BenchmarkPhase
+{
+public:
+	BenchmarkPhase(std::string name, long long operations, int batchOperations, PerfCounters* counters);
+
+	void Start();
+	void Stop();
+
+	/// <summary>
+	/// Adds operations to the current batch and closes it once it holds batchOperations.
+	/// </summary>
+	void Count(int operations);
+
+	Timer timer;
+	PerfCounters* counters;
+	long long counterTotals[PerfCounters::EventCount] = { 0, 0, 0, 0 };
+	long long allocations = 0;
+	long long allocatedBytes = 0;
+
+	/// <summary>
+	/// Nanoseconds per operation of every batch.
+	/// </summary>
+	std::vector<double> latencies;
+
+private:
+	int batchOperations;
+	int batchCount = 0;
+	std::chrono::steady_clock::time_point batchStart;
+	long long allocationsAtStart = 0;
+	long long bytesAtStart = 0;
+
+	/// <summary>
+	/// Keeps the latency of the operations counted since the last batch, if any.
+	/// </summary>
+	void CloseBatch();
+};
+
+inline BenchmarkPhase::BenchmarkPhase(std::string name, long long operations, int batchOperations, PerfCounters* counters)
+	: timer(name, operations), counters(counters), batchOperations(std::max(batchOperations, 1))
+{
+
+}
+
+inline void BenchmarkPhase::Start()
+{
+	if (counters != nullptr)
+	{
+		allocationsAtStart = AllocationCounter::allocations();
+		bytesAtStart = AllocationCounter::bytes();
+		counters->start();
+	}
+	timer.Start();
+	batchStart = std::chrono::steady_clock::now();
+	batchCount = 0;
+}
+
+inline void BenchmarkPhase::Stop()
+{
+	CloseBatch();
+	timer.Stop();
+	if (counters == nullptr)
+	{
+		return;
+	}
+	PerfCounters::Sample sample = counters->stop();
+	for (int event = 0; event < PerfCounters::EventCount; event++)
+	{
+		// One refused read marks the event as unavailable for the whole phase.
+		counterTotals[event] = sample.values[event] < 0 || counterTotals[event] < 0 ? -1 : counterTotals[event] + sample.values[event];
+	}
+	allocations += AllocationCounter::allocations() - allocationsAtStart;
+	allocatedBytes += AllocationCounter::bytes() - bytesAtStart;
+}
+
+inline void BenchmarkPhase::Count(int operations)
+{
+	batchCount += operations;
+	if (batchCount >= batchOperations)
+	{
+		CloseBatch();
+	}
+}
+
+inline void BenchmarkPhase::CloseBatch()
+{
+	if (batchCount == 0)
+	{
+		return;
+	}
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	latencies.push_back(std::chrono::duration<double, std::nano>(now - batchStart).count() / batchCount);
+	batchStart = now;
+	batchCount = 0;
+}
+
+/// <summary>
+/// Runs the benchmark phases of one component type against a fresh decs::Registry per repetition
+/// and keeps the results for the table and JSON output.
+///
+/// Phases of a repetition, in order:
+/// Add Default, Random Access, Update, Remove, Add From Pool, Churn at every churn ratio,
+/// Delete and Construct Copy. Churn destroys the ratio of entities, runs destroyMarked and
+/// spawns as many again with createNewIDs and addComponentsWithIDs, the per frame pattern of a game.
+/// Small ratios of small configurations repeat that frame until a sample has minChurnOperations.
+/// Update and churn run more frames per repetition when needed for minLatencySamples.
+/// </summary>
+class Benchmark
+{
+public:
+	/// <summary>
+	/// Fractions of entities destroyed and respawned by the churn phases.
+	/// </summary>
+	std::vector<double> churnRatios = { 0.01, 0.1, 0.5 };
+
+	/// <summary>
+	/// Least entities destroyed and respawned in one sample of a churn phase, so the time of a
+	/// handful of operations is not dominated by the timer.
+	/// </summary>
+	int minChurnOperations = 1000;
+
+	/// <summary>
+	/// Operations timed together as one latency sample. Reading the clock costs about as much as a
+	/// few cheap operations, so a batch spreads it over enough of them to stay below a nanosecond each.
+	/// </summary>
+	int batchOperations = 64;
+
+	/// <summary>
+	/// Least latency samples the phases that time whole frames collect over all repetitions,
+	/// enough for p99 to differ from the slowest sample.
+	/// </summary>
+	int minLatencySamples = 100;
+
+	/// <summary>
+	/// Configurations whose components would need more bytes than this are skipped.
+	/// </summary>
+	long long memoryBudget = 1024LL * 1024 * 1024;
+
+	/// <summary>
+	/// Collects hardware counters and allocations for every phase. Allocations are only seen
+	/// if the program forwards its operator new to AllocationCounter::record.
+	/// </summary>
+	bool instrument = false;
+
+	/// <summary>
+	/// Runs every phase of config for T. Picks the repetitions from the amount of components
+	/// when config.repetitions is 0.
+	/// </summary>
+	/// <returns>False if the configuration was skipped for the memory budget.</returns>
+	template<class T>
+	bool Run(const char* componentName, BenchmarkConfig config);
+
+	/// <summary>
+	/// Writes one line per phase.
+	/// </summary>
+	void PrintResults(std::ostream& out);
+
+	void WriteJson(std::ostream& out);
+
+	const std::vector<BenchmarkResult>& GetResults();
+
+	/// <summary>
+	/// Bytes of components a configuration keeps alive at its peak, the dense list plus the ids.
+	/// </summary>
+	template<class T>
+	static long long EstimateBytes(const BenchmarkConfig& config);
+
+private:
+	std::vector<BenchmarkResult> results;
+
+	/// <summary>
+	/// Written by the random access phase so the lookups are not optimised away.
+	/// </summary>
+	std::uintptr_t sink = 0;
+
+	std::unique_ptr<PerfCounters> counters;
+
+	BenchmarkPhase Phase(std::string name, long long operations);
+
+	void Add(const char* componentName, int componentSize, const BenchmarkConfig& config, BenchmarkPhase& phase);
+
+	static std::string ChurnName(double ratio);
+
+	/// <summary>
+	/// Frames a phase doing frameOperations per frame runs per repetition so its batches give
+	/// minLatencySamples over every repetition.
+	/// </summary>
+	int FramesFor(long long frameOperations, int repetitions);
+
+	/// <summary>
+	/// Percentile p of sorted samples using the nearest rank, or -1 if there are fewer than
+	/// 100 / (100 - p) samples and it could only repeat the slowest one.
+	/// </summary>
+	static double PercentileOf(const std::vector<double>& sorted, double p);
+};
+
+template<class T>
+inline bool Benchmark::Run(const char* componentName, BenchmarkConfig config)
+{
+	if (EstimateBytes<T>(config) > memoryBudget)
+	{
+		return false;
+	}
+
+	const int count = config.components;
+	const int perID = config.componentsPerID;
+	const long long total = static_cast<long long>(count) * perID;
+	if (config.repetitions <= 0)
+	{
+		config.repetitions = static_cast<int>(std::min(25LL, std::max(3LL, 2000000LL / total)));
+	}
+
+	if (instrument && counters == nullptr)
+	{
+		counters.reset(new PerfCounters());
+	}
+	AllocationCounter::setEnabled(instrument);
+
+	std::vector<int> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::shuffle(order.begin(), order.end(), std::mt19937(12345));
+
+	const int updateFrames = FramesFor(total, config.repetitions);
+	BenchmarkPhase addDefault = Phase("Add Default", total);
+	BenchmarkPhase randomAccess = Phase("Random Access", count);
+	BenchmarkPhase update = Phase("Update", total * updateFrames);
+	BenchmarkPhase remove = Phase("Remove", count);
+	BenchmarkPhase addFromPool = Phase("Add From Pool", total);
+	std::vector<BenchmarkPhase> churn;
+	std::vector<int> churnBatches;
+	std::vector<int> churnFrames;
+	for (double ratio : churnRatios)
+	{
+		int batch = std::max(1, static_cast<int>(count * ratio));
+		int frames = std::max((minChurnOperations + batch - 1) / batch, FramesFor(batch, config.repetitions));
+		churnBatches.push_back(batch);
+		churnFrames.push_back(frames);
+		churn.push_back(Phase(ChurnName(ratio), static_cast<long long>(batch) * frames));
+	}
+	BenchmarkPhase destroy = Phase("Delete", count);
+	BenchmarkPhase addCopy = Phase("Construct Copy", count);
+
+	std::vector<int> ids(count);
+	std::vector<int> spawned(count);
+	for (int repetition = 0; repetition < config.repetitions; repetition++)
+	{
+		decs::Registry registry;
+		decs::System<T> system(registry);
+		if (config.threads > 0)
+		{
+			registry.setThreadCount(config.threads);
+			system.setCanUpdateInParallel(true);
+		}
+
+		addDefault.Start();
+		for (int i = 0; i < count; i++)
+		{
+			ids[i] = registry.createNewID();
+			for (int j = 0; j < perID; j++)
+			{
+				system.addComponentWithID(ids[i]);
+			}
+			addDefault.Count(perID);
+		}
+		addDefault.Stop();
+
+		randomAccess.Start();
+		for (int i = 0; i < count; i++)
+		{
+			sink += reinterpret_cast<std::uintptr_t>(system.getPtrComponentWithID(ids[order[i]]));
+			randomAccess.Count(1);
+		}
+		randomAccess.Stop();
+
+		update.Start();
+		for (int frame = 0; frame < updateFrames; frame++)
+		{
+			system.update();
+			update.Count(static_cast<int>(total));
+		}
+		update.Stop();
+
+		remove.Start();
+		for (int i = 0; i < count; i++)
+		{
+			system.removeAllComponentsWithID(ids[i]);
+			remove.Count(1);
+		}
+		remove.Stop();
+
+		addFromPool.Start();
+		for (int i = 0; i < count; i++)
+		{
+			for (int j = 0; j < perID; j++)
+			{
+				system.addComponentWithID(ids[i]);
+			}
+			addFromPool.Count(perID);
+		}
+		addFromPool.Stop();
+
+		for (size_t c = 0; c < churnRatios.size(); c++)
+		{
+			int churned = churnBatches[c];
+
+			churn[c].Start();
+			for (int frame = 0; frame < churnFrames[c]; frame++)
+			{
+				for (int i = 0; i < churned; i++)
+				{
+					registry.destroyEntity(ids[order[i]]);
+				}
+				registry.destroyMarked();
+				registry.createNewIDs(spawned.data(), churned);
+				for (int j = 0; j < perID; j++)
+				{
+					system.addComponentsWithIDs(spawned.data(), churned);
+				}
+				for (int i = 0; i < churned; i++)
+				{
+					ids[order[i]] = spawned[i];
+				}
+				churn[c].Count(churned);
+			}
+			churn[c].Stop();
+		}
+
+		destroy.Start();
+		for (int i = 0; i < count; i++)
+		{
+			system.destroyAllComponentsWithID(ids[i]);
+			destroy.Count(1);
+		}
+		destroy.Stop();
+
+		T copy;
+		addCopy.Start();
+		for (int i = 0; i < count; i++)
+		{
+			system.addComponentValuesWithID(registry.createNewID(), copy);
+			addCopy.Count(1);
+		}
+		addCopy.Stop();
+	}
+
+	Add(componentName, sizeof(T), config, addDefault);
+	Add(componentName, sizeof(T), config, randomAccess);
+	Add(componentName, sizeof(T), config, update);
+	Add(componentName, sizeof(T), config, remove);
+	Add(componentName, sizeof(T), config, addFromPool);
+	for (BenchmarkPhase& phase : churn)
+	{
+		Add(componentName, sizeof(T), config, phase);
+	}
+	Add(componentName, sizeof(T), config, destroy);
+	Add(componentName, sizeof(T), config, addCopy);
+	AllocationCounter::setEnabled(false);
+	return true;
+}
+
+template<class T>
+inline long long Benchmark::EstimateBytes(const BenchmarkConfig& config)
+{
+	// Dense list, its growth headroom and the sparse index of every id.
+	long long components = static_cast<long long>(config.components) * config.componentsPerID;
+	return components * static_cast<long long>(sizeof(T)) * 2 + static_cast<long long>(config.components) * 16;
+}
+
+inline void Benchmark::PrintResults(std::ostream& out)
+{
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	bool instrumented = false;
+	for (const BenchmarkResult& result : results)
+	{
+		instrumented = instrumented || result.instrumented;
+	}
+
+	out << std::left << std::setw(18) << "component" << std::right << std::setw(6) << "bytes"
+		<< std::setw(10) << "count" << std::setw(7) << "perID" << "  " << std::left << std::setw(16) << "phase"
+		<< std::right << std::setw(6) << "reps" << std::setw(10) << "ns/op"
+		<< std::setw(13) << "min ns" << std::setw(13) << "max ns" << std::setw(10) << "samples"
+		<< std::setw(11) << "p50 ns/op" << std::setw(11) << "p90 ns/op" << std::setw(11) << "p99 ns/op";
+	if (instrumented)
+	{
+		out << std::setw(11) << "cycles/op" << std::setw(10) << "L1D/op" << std::setw(10) << "LLC/op"
+			<< std::setw(10) << "brmiss/op" << std::setw(10) << "allocs/op" << std::setw(10) << "B/op";
+	}
+	out << std::endl;
+
+	out << std::fixed << std::setprecision(2);
+	for (const BenchmarkResult& result : results)
+	{
+		out << std::left << std::setw(18) << result.component << std::right << std::setw(6) << result.componentSize
+			<< std::setw(10) << result.config.components << std::setw(7) << result.config.componentsPerID
+			<< "  " << std::left << std::setw(16) << result.phase
+			<< std::right << std::setw(6) << result.repetitions << std::setw(10) << result.nsPerOp
+			<< std::setw(13) << result.min << std::setw(13) << result.max << std::setw(10) << result.latencySamples;
+		for (double percentile : { result.p50, result.p90, result.p99 })
+		{
+			out << std::setw(11);
+			if (percentile < 0)
+			{
+				out << "n/a";
+			}
+			else
+			{
+				out << percentile;
+			}
+		}
+		if (result.instrumented)
+		{
+			for (int event = 0; event < PerfCounters::EventCount; event++)
+			{
+				out << std::setw(event == 0 ? 11 : 10);
+				if (result.counters[event] < 0)
+				{
+					out << "n/a";
+				}
+				else
+				{
+					out << result.counters[event];
+				}
+			}
+			out << std::setw(10) << result.allocations << std::setw(10) << result.allocatedBytes;
+		}
+		out << std::endl;
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+inline void Benchmark::WriteJson(std::ostream& out)
+{
+	std::ios_base::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	out << std::fixed << std::setprecision(3);
+
+	out << "{\"hardwareThreads\":" << std::thread::hardware_concurrency() << ",\"results\":[";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		out << (i == 0 ? "" : ",") << "\n{\"component\":\"" << result.component << "\""
+			<< ",\"componentSize\":" << result.componentSize
+			<< ",\"count\":" << result.config.components
+			<< ",\"componentsPerID\":" << result.config.componentsPerID
+			<< ",\"threads\":" << result.config.threads
+			<< ",\"phase\":\"" << result.phase << "\""
+			<< ",\"operations\":" << result.operations
+			<< ",\"repetitions\":" << result.repetitions
+			<< ",\"nsPerOp\":" << result.nsPerOp
+			<< ",\"minNs\":" << result.min
+			<< ",\"maxNs\":" << result.max
+			<< ",\"meanNs\":" << result.mean
+			<< ",\"latencySamples\":" << result.latencySamples;
+		// Per operation, null when there are too few samples for the percentile.
+		const char* percentileNames[] = { "p50NsPerOp", "p90NsPerOp", "p99NsPerOp" };
+		double percentiles[] = { result.p50, result.p90, result.p99 };
+		for (int p = 0; p < 3; p++)
+		{
+			out << ",\"" << percentileNames[p] << "\":";
+			if (percentiles[p] < 0)
+			{
+				out << "null";
+			}
+			else
+			{
+				out << percentiles[p];
+			}
+		}
+		// Per operation, null when not collected.
+		for (int event = 0; event < PerfCounters::EventCount; event++)
+		{
+			out << ",\"" << PerfCounters::eventName(event) << "PerOp\":";
+			if (result.instrumented && result.counters[event] >= 0)
+			{
+				out << result.counters[event];
+			}
+			else
+			{
+				out << "null";
+			}
+		}
+		if (result.instrumented)
+		{
+			out << ",\"allocationsPerOp\":" << result.allocations << ",\"allocatedBytesPerOp\":" << result.allocatedBytes;
+		}
+		else
+		{
+			out << ",\"allocationsPerOp\":null,\"allocatedBytesPerOp\":null";
+		}
+		out << "}";
+	}
+	out << "\n]}\n";
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+inline const std::vector<BenchmarkResult>& Benchmark::GetResults()
+{
+	return results;
+}
+
+inline void Benchmark::Add(const char* componentName, int componentSize, const BenchmarkConfig& config, BenchmarkPhase& phase)
+{
+	BenchmarkResult result;
+	result.component = componentName;
+	result.componentSize = componentSize;
+	result.config = config;
+	result.phase = phase.timer.name;
+	result.operations = phase.timer.operations;
+	result.repetitions = phase.timer.SampleCount();
+	result.nsPerOp = phase.timer.NanosecondsPerOperation();
+	result.min = phase.timer.Fastest();
+	std::sort(phase.latencies.begin(), phase.latencies.end());
+	result.latencySamples = static_cast<int>(phase.latencies.size());
+	result.p50 = PercentileOf(phase.latencies, 50);
+	result.p90 = PercentileOf(phase.latencies, 90);
+	result.p99 = PercentileOf(phase.latencies, 99);
+	result.max = phase.timer.Slowest();
+	result.mean = phase.timer.Mean();
+	if (phase.counters != nullptr && result.repetitions > 0)
+	{
+		double operations = static_cast<double>(result.operations) * result.repetitions;
+		result.instrumented = true;
+		for (int event = 0; event < PerfCounters::EventCount; event++)
+		{
+			result.counters[event] = phase.counterTotals[event] < 0 ? -1 : phase.counterTotals[event] / operations;
+		}
+		result.allocations = phase.allocations / operations;
+		result.allocatedBytes = phase.allocatedBytes / operations;
+	}
+	results.push_back(result);
+}
+
+inline BenchmarkPhase Benchmark::Phase(std::string name, long long operations)
+{
+	return BenchmarkPhase(name, operations, batchOperations, instrument ? counters.get() : nullptr);
+}
+
+inline int Benchmark::FramesFor(long long frameOperations, int repetitions)
+{
+	// Operations a batch ends up with when it is closed at the end of a frame.
+	long long framesPerBatch = (batchOperations + frameOperations - 1) / frameOperations;
+	long long batchesPerRepetition = (minLatencySamples + repetitions - 1) / repetitions;
+	return static_cast<int>(std::max(1LL, batchesPerRepetition * framesPerBatch));
+}
+
+inline double Benchmark::PercentileOf(const std::vector<double>& sorted, double p)
+{
+	if (sorted.size() * (100 - p) < 100)
+	{
+		return -1;
+	}
+	size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+	rank = std::min(std::max(rank, static_cast<size_t>(1)), sorted.size());
+	return sorted[rank - 1];
+}
+
+inline std::string Benchmark::ChurnName(double ratio)
+{
+	return "Churn " + std::to_string(static_cast<int>(ratio * 100 + 0.5)) + "%";
+}
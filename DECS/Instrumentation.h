@@ -0,0 +1,223 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Counts the calls to the global operator new while enabled. The program replaces operator new
+/// and calls record(), see Source.cpp, so every allocation is seen including the ones decs makes
+/// through the default Memory::resource().
+/// </summary>
+class AllocationCounter
+{
+public:
+	static void record(size_t bytes);
+
+	static void setEnabled(bool enable);
+
+	static long long allocations();
+	static long long bytes();
+
+private:
+	inline static std::atomic<bool> enabled{ false };
+	inline static std::atomic<long long> allocationCount{ 0 };
+	inline static std::atomic<long long> allocatedBytes{ 0 };
+};
+
+inline void AllocationCounter::record(size_t size)
+{
+	if (enabled.load(std::memory_order_relaxed))
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+	}
+}
+
+inline void AllocationCounter::setEnabled(bool enable)
+{
+	enabled.store(enable);
+}
+
+inline long long AllocationCounter::allocations()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+inline long long AllocationCounter::bytes()
+{
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Hardware counters of the calling thread read through perf_event_open. Work done by the
+/// thread pool is not included, run with --threads 0 for the full cost of update.
+/// Counters the kernel or CPU refuses, for example with perf_event_paranoid above 2 or in
+/// a virtual machine, read as -1. Always unavailable on other platforms.
+/// </summary>
+class PerfCounters
+{
+public:
+	enum Event
+	{
+		Cycles,
+		L1DataMisses,
+		LastLevelMisses,
+		BranchMisses,
+		EventCount
+	};
+
+	/// <summary>
+	/// Values of every event, -1 where the event could not be opened.
+	/// </summary>
+	struct Sample
+	{
+		long long values[EventCount];
+	};
+
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/// <summary>
+	/// Returns true if at least one event could be opened.
+	/// </summary>
+	bool available() const;
+
+	/// <summary>
+	/// Resets and starts every event.
+	/// </summary>
+	void start();
+
+	/// <summary>
+	/// Stops every event and returns the counts since start(), scaled up when the kernel
+	/// had to multiplex the events. Every value is -1 if the events never got to run.
+	/// </summary>
+	Sample stop();
+
+	static const char* eventName(int event);
+
+private:
+	int descriptors[EventCount];
+	int leader = -1;
+};
+
+inline PerfCounters::PerfCounters()
+{
+	for (int event = 0; event < EventCount; event++)
+	{
+		descriptors[event] = -1;
+	}
+#if defined(__linux__)
+	const std::uint32_t types[EventCount] = { PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+	const std::uint64_t configs[EventCount] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	for (int event = 0; event < EventCount; event++)
+	{
+		perf_event_attr attributes;
+		std::memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = types[event];
+		attributes.config = configs[event];
+		attributes.disabled = leader == -1 ? 1 : 0;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		descriptors[event] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0));
+		if (descriptors[event] != -1 && leader == -1)
+		{
+			leader = descriptors[event];
+		}
+	}
+#endif
+}
+
+inline PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+	for (int event = 0; event < EventCount; event++)
+	{
+		if (descriptors[event] != -1)
+		{
+			close(descriptors[event]);
+		}
+	}
+#endif
+}
+
+inline bool PerfCounters::available() const
+{
+	return leader != -1;
+}
+
+inline void PerfCounters::start()
+{
+#if defined(__linux__)
+	if (leader != -1)
+	{
+		ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+#endif
+}
+
+inline PerfCounters::Sample PerfCounters::stop()
+{
+	Sample sample;
+	for (int event = 0; event < EventCount; event++)
+	{
+		sample.values[event] = -1;
+	}
+#if defined(__linux__)
+	if (leader == -1)
+	{
+		return sample;
+	}
+	ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	// Group layout: number of events, time enabled, time running, then one value per open event in open order.
+	std::uint64_t buffer[3 + EventCount];
+	if (read(leader, buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t)))
+	{
+		return sample;
+	}
+	// The events never got onto the PMU, for example when more groups compete than it has counters.
+	if (buffer[2] == 0)
+	{
+		return sample;
+	}
+	double scale = static_cast<double>(buffer[1]) / buffer[2];
+	std::uint64_t next = 0;
+	for (int event = 0; event < EventCount && next < buffer[0]; event++)
+	{
+		if (descriptors[event] != -1)
+		{
+			sample.values[event] = static_cast<long long>(buffer[3 + next] * scale);
+			next++;
+		}
+	}
+#endif
+	return sample;
+}
+
+inline const char* PerfCounters::eventName(int event)
+{
+	static const char* names[EventCount] = { "cycles", "l1dMisses", "llcMisses", "branchMisses" };
+	return names[event];
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "dcs.h"
+#include <ostream>
+
+/// <summary>
+/// Component read by both reader systems. It is stored as arrays and its changes are tracked, so reading it
+/// through getComponentWithID would write a Reference back and stamp a tick on every call.
+/// </summary>
+struct ReadTarget : public decs::PodComponent<ReadTarget>
+{
+	float x = 1.0f;
+	float y = 2.0f;
+
+	using Storage = decs::SoAStorage<ReadTarget, &ReadTarget::x, &ReadTarget::y>;
+};
+
+/// <summary>
+/// Sums the ReadTarget of its entity every update, the two reader types only differ so they get a system each.
+/// </summary>
+template<int Reader>
+struct ReadTargetReader : public decs::PodComponent<ReadTargetReader<Reader>>
+{
+	double sum = 0;
+
+	void update()
+	{
+		decs::System<ReadTarget> targets;
+		ReadTarget target = targets.readComponentWithID(this->belongsToID());
+		sum += target.x + target.y;
+	}
+};
+
+/// <summary>
+/// Runs two systems that declared readsComponents<ReadTarget>() at the same time and checks they saw every
+/// value and changed no tick. Build with -fsanitize=thread to also check the reads don't race.
+/// </summary>
+/// <param name="out">Stream the result is written to.</param>
+/// <returns>True if the test passed.</returns>
+inline bool RunParallelReadTest(std::ostream& out)
+{
+	const int count = 10000;
+	const int updates = 50;
+
+	decs::Registry registry;
+	decs::Registry::Scope scope(registry);
+	registry.setThreadCount(3);
+	decs::System<ReadTarget> targets(registry);
+	decs::System<ReadTargetReader<0>> first(registry);
+	decs::System<ReadTargetReader<1>> second(registry);
+	targets.setCanUpdate(false);
+	targets.setChangeTracking(true);
+	first.readsComponents<ReadTarget>();
+	second.readsComponents<ReadTarget>();
+
+	for (int i = 0; i < count; i++)
+	{
+		int id = registry.createNewID();
+		targets.addComponentWithID(id);
+		first.addComponentWithID(id);
+		second.addComponentWithID(id);
+	}
+	std::uint32_t addedTick = registry.getChangeTick();
+
+	for (int i = 0; i < updates; i++)
+	{
+		registry.update();
+	}
+
+	bool passed = true;
+	for (int position = 0; position < count; position++)
+	{
+		passed = passed && registry.getSparseSet<ReadTarget>().changeTickAt(position) == addedTick;
+		passed = passed && first.getDenseList()[position].sum == 3.0 * updates;
+		passed = passed && second.getDenseList()[position].sum == 3.0 * updates;
+	}
+	out << "Parallel read test " << (passed ? "passed" : "failed") << std::endl;
+	return passed;
+}
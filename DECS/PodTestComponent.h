@@ -0,0 +1,27 @@
+#pragma once
+#include "dcs.h"
+
+/// <summary>
+/// 60 byte component without virtual functions, sits between the empty T2C
+/// and the 800+ byte TestComponent in the benchmarks.
+/// </summary>
+class PodTestComponent : public decs::PodComponent<PodTestComponent>
+{
+public:
+	void initialise()
+	{
+		velocity = 1.0f;
+	}
+
+	void update()
+	{
+		for (int index = 0; index < 12; index++)
+		{
+			values[index] += velocity;
+		}
+	}
+
+private:
+	float velocity = 0.0f;
+	float values[12] = {};
+};
@@ -0,0 +1,482 @@
+#pragma once
+#include "dcs.h"
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Component with a value the regression tests can recognise.
+/// </summary>
+struct RegressionValue : public decs::PodComponent<RegressionValue>
+{
+	int value = 0;
+};
+
+/// <summary>
+/// The same component stored as arrays.
+/// </summary>
+struct RegressionSoAValue : public decs::PodComponent<RegressionSoAValue>
+{
+	int value = 0;
+
+	using Storage = decs::SoAStorage<RegressionSoAValue, &RegressionSoAValue::value>;
+};
+
+/// <summary>
+/// The same component stored in chunks.
+/// </summary>
+struct RegressionChunkedValue : public decs::PodComponent<RegressionChunkedValue>
+{
+	int value = 0;
+
+	using Storage = decs::ChunkedStorage<RegressionChunkedValue>;
+};
+
+/// <summary>
+/// Removes a component so its element is pooled, then adds a copy and emplaces a value and checks the new
+/// components hold those values and activity rather than the pooled element's.
+/// </summary>
+/// <returns>True if the test passed.</returns>
+template<class T>
+inline bool TestPooledInsert()
+{
+	decs::Registry registry;
+	decs::Registry::Scope scope(registry);
+	decs::System<T> values(registry);
+	values.setCanUpdate(false);
+
+	int kept = registry.createNewID();
+	int removed = registry.createNewID();
+	T stale;
+	stale.value = 7;
+	values.addComponentWithID(kept);
+	values.addComponentValuesWithID(removed, stale);
+	values.setComponentActiveWithID(removed, false);
+	values.removeComponentWithID(removed);
+
+	bool passed = values.getDenseList().size() == 2;
+
+	T copy;
+	copy.value = 42;
+	int copied = registry.createNewID();
+	values.addComponentValuesWithID(copied, copy);
+	passed = passed && values.getDenseList().size() == 2;
+	passed = passed && values.readComponentWithID(copied).value == 42;
+	passed = passed && values.readComponentWithID(copied).isActive();
+	passed = passed && values.readComponentWithID(copied).belongsToID() == copied;
+	passed = passed && values.getNumberOfActiveComponents() == 2;
+
+	values.removeComponentWithID(copied);
+	T emplaced;
+	emplaced.value = 43;
+	int placed = registry.createNewID();
+	values.emplaceComponentWithID(placed, std::move(emplaced));
+	passed = passed && values.getDenseList().size() == 2;
+	passed = passed && values.readComponentWithID(placed).value == 43;
+	passed = passed && values.readComponentWithID(placed).isActive();
+	passed = passed && values.getNumberOfActiveComponents() == 2;
+	passed = passed && values.readComponentWithID(kept).value == 0;
+	return passed;
+}
+
+/// <summary>
+/// Fills a registry, resets it and checks nothing of the old entities is left and it can be filled again.
+/// </summary>
+/// <returns>True if the test passed.</returns>
+inline bool TestRegistryReset()
+{
+	decs::Registry registry;
+	decs::Registry::Scope scope(registry);
+	decs::System<RegressionValue> values(registry);
+	decs::System<RegressionSoAValue> arrays(registry);
+	values.setCanUpdate(false);
+	arrays.setCanUpdate(false);
+	values.setObserving(true);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		int id = registry.createNewID();
+		values.addComponentWithID(id);
+		arrays.addComponentWithID(id);
+	}
+	// Recorded for the old entity 0, must not reach the new one.
+	registry.destroyEntity(0);
+	registry.reset();
+
+	std::vector<int> found;
+	registry.query(decs::Signature::of<RegressionValue>(), decs::Signature(), found);
+	bool passed = found.empty();
+	passed = passed && values.getDenseList().size() == 0 && arrays.getDenseList().size() == 0;
+	passed = passed && !values.hasComponentWithID(0) && !arrays.hasComponentWithID(0);
+	passed = passed && values.getAddedIDs().size() == 0;
+
+	int id = registry.createNewID();
+	values.addComponentWithID(id);
+	registry.destroyMarked();
+	passed = passed && id == 0;
+	passed = passed && values.getNumberOfActiveComponents() == 1 && values.hasComponentWithID(0);
+	registry.query(decs::Signature::of<RegressionValue>(), decs::Signature(), found);
+	passed = passed && found.size() == 1 && found[0] == 0;
+	return passed;
+}
+
+/// <summary>
+/// Adds, toggles, removes and destroys components of a few ids that each hold several, and after every step checks
+/// each id still holds exactly its own values, in the order they are in the dense list. Removing swaps the last element
+/// into the hole, which has to move the right position of an id with several components and keep its positions sorted.
+/// </summary>
+/// <returns>True if the test passed.</returns>
+template<class T>
+inline bool TestRemoveWithSeveralPerID()
+{
+	decs::Registry registry;
+	decs::System<T> values(registry);
+	values.setCanUpdate(false);
+
+	const int idCount = 6;
+	for (int i = 0; i < idCount; i++)
+	{
+		registry.createNewID();
+	}
+
+	// Value and activity of every component each id should hold.
+	std::vector<std::vector<std::pair<int, bool>>> expected(idCount);
+	std::mt19937 random(17);
+	int nextValue = 0;
+	bool passed = true;
+	for (int step = 0; step < 2000 && passed; step++)
+	{
+		int id = static_cast<int>(random() % idCount);
+		int count = values.getNumberOfComponentsWithID(id);
+		int action = static_cast<int>(random() % 5);
+		if (action < 2 || count == 0)
+		{
+			T added;
+			added.value = nextValue++;
+			values.addComponentValuesWithID(id, added);
+			expected[id].push_back({ added.value, true });
+			continue;
+		}
+
+		int index = static_cast<int>(random() % count);
+		T current = values.readComponentWithIDAtIndex(id, index);
+		auto found = std::find(expected[id].begin(), expected[id].end(), std::make_pair(current.value, current.isActive()));
+		if (found == expected[id].end())
+		{
+			passed = false;
+			break;
+		}
+		if (action == 2)
+		{
+			values.setComponentActiveWithIDAtIndex(id, index, !current.isActive());
+			found->second = !current.isActive();
+		}
+		else
+		{
+			if (action == 3)
+			{
+				values.removeComponentWithIDAtIndex(id, index);
+			}
+			else
+			{
+				values.destroyComponentWithIDAtIndex(id, index);
+			}
+			expected[id].erase(found);
+		}
+
+		std::vector<std::vector<std::pair<int, bool>>> inDenseOrder(idCount);
+		for (int position = 0; passed && position < values.getNumberOfActiveComponents(); position++)
+		{
+			T component = decs::readAt(values.getDenseList(), position);
+			passed = component.belongsToID() >= 0 && component.belongsToID() < idCount;
+			if (passed)
+			{
+				inDenseOrder[component.belongsToID()].push_back({ component.value, component.isActive() });
+			}
+		}
+
+		int total = 0;
+		for (int checked = 0; passed && checked < idCount; checked++)
+		{
+			std::vector<std::pair<int, bool>> held;
+			for (int i = 0; i < values.getNumberOfComponentsWithID(checked); i++)
+			{
+				T component = values.readComponentWithIDAtIndex(checked, i);
+				held.push_back({ component.value, component.isActive() });
+			}
+			std::vector<std::pair<int, bool>> wanted = expected[checked];
+			passed = held == inDenseOrder[checked];
+			std::sort(held.begin(), held.end());
+			std::sort(wanted.begin(), wanted.end());
+			passed = passed && held == wanted;
+			total += static_cast<int>(wanted.size());
+		}
+		passed = passed && values.getNumberOfActiveComponents() == total;
+	}
+	return passed;
+}
+
+/// <summary>
+/// Destroys entities twice in the same commands and again once they are free, then checks each id is
+/// pooled once: creating ids hands every destroyed one out a single time before new ones.
+/// </summary>
+/// <returns>True if the test passed.</returns>
+inline bool TestDestroyTwice()
+{
+	decs::Registry registry;
+	decs::System<RegressionValue> values(registry);
+	values.setCanUpdate(false);
+
+	int ids[4];
+	for (int& id : ids)
+	{
+		id = registry.createNewID();
+	}
+	values.addComponentWithID(ids[0]);
+	values.addComponentWithID(ids[1]);
+	values.addComponentWithID(ids[2]);
+
+	// ids[3] has no components, so it is released without going through the systems.
+	registry.destroyEntity(ids[1]);
+	registry.destroyEntity(ids[1]);
+	registry.destroyEntity(ids[3]);
+	registry.destroyEntity(ids[3]);
+	registry.destroyMarked();
+	registry.destroyEntity(ids[1]);
+	registry.destroyMarked();
+
+	bool passed = !values.hasComponentWithID(ids[1]);
+	passed = passed && values.hasComponentWithID(ids[0]) && values.hasComponentWithID(ids[2]);
+	passed = passed && values.getNumberOfActiveComponents() == 2;
+
+	std::vector<int> created;
+	for (int i = 0; i < 4; i++)
+	{
+		created.push_back(registry.createNewID());
+	}
+	std::sort(created.begin(), created.end());
+	passed = passed && created == std::vector<int>{ ids[1], ids[3], 4, 5 };
+	return passed;
+}
+
+/// <summary>
+/// A registry with a system of each storage.
+/// </summary>
+struct RegressionWorld
+{
+	decs::Registry registry;
+	decs::System<RegressionValue> values;
+	decs::System<RegressionSoAValue> arrays;
+	decs::System<RegressionChunkedValue> chunks;
+
+	/// <summary>
+	/// Creates count entities, some with several components and some inactive, and destroys a few so the
+	/// id pool isn't empty. The values depend on seed.
+	/// </summary>
+	/// <param name="seed">Added to every value.</param>
+	/// <param name="count">Number of entities to create.</param>
+	RegressionWorld(int seed, int count)
+		: values(registry), arrays(registry), chunks(registry)
+	{
+		values.setCanUpdate(false);
+		arrays.setCanUpdate(false);
+		chunks.setCanUpdate(false);
+		for (int i = 0; i < count; i++)
+		{
+			int id = registry.createNewID();
+			RegressionValue value;
+			value.value = seed + i;
+			values.addComponentValuesWithID(id, value);
+			if (i % 3 == 0)
+			{
+				value.value = seed - i;
+				values.addComponentValuesWithID(id, value);
+			}
+			if (i % 2 == 0)
+			{
+				RegressionSoAValue array;
+				array.value = seed * 2 + i;
+				arrays.addComponentValuesWithID(id, array);
+			}
+			if (i % 5 == 0)
+			{
+				RegressionChunkedValue chunk;
+				chunk.value = seed * 3 + i;
+				chunks.addComponentValuesWithID(id, chunk);
+			}
+		}
+		values.setComponentActiveWithIDAtIndex(0, 1, false);
+		arrays.setComponentActiveWithID(2, false);
+		registry.destroyEntity(4);
+		registry.destroyEntity(7);
+		registry.destroyMarked();
+	}
+
+	/// <summary>
+	/// Writes the next id, change tick, every component and the result of a query to a list, so two
+	/// worlds hold the same entities if their lists are equal.
+	/// </summary>
+	/// <returns>The list.</returns>
+	std::vector<int> state()
+	{
+		std::vector<int> written;
+		int idCount = registry.getNextAvailableEntityID();
+		written.push_back(idCount);
+		written.push_back(static_cast<int>(registry.getChangeTick()));
+		writeState(values, idCount, written);
+		writeState(arrays, idCount, written);
+		writeState(chunks, idCount, written);
+
+		std::vector<int> found;
+		registry.query(decs::Signature::of<RegressionValue, RegressionSoAValue>(), decs::Signature::of<RegressionChunkedValue>(), found);
+		written.insert(written.end(), found.begin(), found.end());
+		return written;
+	}
+
+	/// <summary>
+	/// Creates count ids and checks each one is new and holds no components.
+	/// </summary>
+	/// <param name="count">Number of ids to create.</param>
+	/// <returns>True if every id was free.</returns>
+	bool createsFreeIDs(int count)
+	{
+		std::vector<int> created;
+		for (int i = 0; i < count; i++)
+		{
+			int id = registry.createNewID();
+			if (id < 0 || std::find(created.begin(), created.end(), id) != created.end()
+				|| values.hasComponentWithID(id) || arrays.hasComponentWithID(id) || chunks.hasComponentWithID(id))
+			{
+				return false;
+			}
+			created.push_back(id);
+		}
+		return true;
+	}
+
+private:
+	template<class T>
+	static void writeState(decs::System<T>& system, int idCount, std::vector<int>& written)
+	{
+		written.push_back(system.getNumberOfActiveComponents());
+		written.push_back(static_cast<int>(system.getDenseList().size()));
+		for (int id = 0; id < idCount; id++)
+		{
+			int count = system.getNumberOfComponentsWithID(id);
+			written.push_back(count);
+			for (int i = 0; i < count; i++)
+			{
+				T component = system.readComponentWithIDAtIndex(id, i);
+				written.push_back(component.value);
+				written.push_back(component.isActive());
+			}
+		}
+	}
+};
+
+/// <summary>
+/// Restores a snapshot into a registry holding other entities and checks it then holds the same
+/// components and hands out the same ids as the registry the snapshot was taken of.
+/// </summary>
+/// <returns>True if the test passed.</returns>
+inline bool TestSnapshotRoundTrip()
+{
+	RegressionWorld source(1000, 40);
+	std::stringstream stream;
+	bool passed = source.registry.snapshot(stream);
+
+	RegressionWorld target(2000, 25);
+	passed = passed && target.registry.restore(stream);
+	passed = passed && target.state() == source.state();
+	for (int i = 0; i < 3; i++)
+	{
+		passed = passed && target.registry.createNewID() == source.registry.createNewID();
+	}
+	return passed;
+}
+
+/// <summary>
+/// Restores every cut short copy of a snapshot and copies with a flipped byte, and checks each one that is
+/// refused left the registry as it was, its id pool included, and each one that is restored still hands out free ids.
+/// </summary>
+/// <returns>True if the test passed.</returns>
+inline bool TestSnapshotRejected()
+{
+	RegressionWorld source(1000, 40);
+	std::stringstream stream;
+	bool passed = source.registry.snapshot(stream);
+	const std::string snapshot = stream.str();
+
+	std::unique_ptr<RegressionWorld> target(new RegressionWorld(2000, 25));
+	const std::vector<int> before = target->state();
+	for (size_t length = 0; passed && length < snapshot.size(); length++)
+	{
+		std::stringstream cut(snapshot.substr(0, length));
+		passed = !target->registry.restore(cut) && target->state() == before;
+	}
+
+	// Component values are taken as they are, so a flipped byte in one is restored and the world is built again.
+	int refused = 0;
+	for (size_t position = 0; passed && position < snapshot.size(); position++)
+	{
+		std::string corrupt = snapshot;
+		corrupt[position] = static_cast<char>(~corrupt[position]);
+		std::stringstream in(corrupt);
+		if (target->registry.restore(in))
+		{
+			passed = target->createsFreeIDs(50);
+			target.reset(new RegressionWorld(2000, 25));
+			continue;
+		}
+		++refused;
+		passed = target->state() == before;
+	}
+	passed = passed && refused > 0;
+
+	RegressionWorld untouched(2000, 25);
+	for (int i = 0; i < 3; i++)
+	{
+		passed = passed && target->registry.createNewID() == untouched.registry.createNewID();
+	}
+	return passed;
+}
+
+/// <summary>
+/// Runs every regression test and writes which ones failed.
+/// </summary>
+/// <param name="out">Stream the results are written to.</param>
+/// <returns>True if every test passed.</returns>
+inline bool RunRegressionTests(std::ostream& out)
+{
+	struct Test
+	{
+		const char* name;
+		bool (*run)();
+	};
+	const Test tests[] = {
+		{ "Pooled insert", &TestPooledInsert<RegressionValue> },
+		{ "Pooled insert SoA", &TestPooledInsert<RegressionSoAValue> },
+		{ "Pooled insert chunked", &TestPooledInsert<RegressionChunkedValue> },
+		{ "Registry reset", &TestRegistryReset },
+		{ "Remove with several per id", &TestRemoveWithSeveralPerID<RegressionValue> },
+		{ "Remove with several per id SoA", &TestRemoveWithSeveralPerID<RegressionSoAValue> },
+		{ "Remove with several per id chunked", &TestRemoveWithSeveralPerID<RegressionChunkedValue> },
+		{ "Destroy twice", &TestDestroyTwice },
+		{ "Snapshot round trip", &TestSnapshotRoundTrip },
+		{ "Snapshot rejected", &TestSnapshotRejected },
+	};
+
+	bool passed = true;
+	for (const Test& test : tests)
+	{
+		bool result = test.run();
+		out << test.name << " test " << (result ? "passed" : "failed") << std::endl;
+		passed = passed && result;
+	}
+	return passed;
+}
@@ -1,139 +1,214 @@
+/*
+	Benchmark suite of decs. Builds with the Visual Studio project, or on Linux with
+	g++ -std=c++17 -O2 -pthread Source.cpp -o decs_benchmark
+
+	Arguments:
+	--quick				1k and 10k components only
+	--full				adds 10M components to the sweep
+	--repetitions N		runs of every phase, picked from the amount of components otherwise
+	--threads N			threads of the parallel update, 0 updates on the calling thread
+	--memory MB			skips configurations that need more, 1024 by default
+	--counters			adds hardware counters and allocations per operation to every phase,
+						hardware counters need Linux with perf_event_paranoid at 2 or below
+	--json FILE			also writes the results as JSON, - for stdout
+	--parallel-read-test	only runs the test of ParallelReadTest.h, build it with -fsanitize=thread
+						-g -O1 added to check the reads for races
+	--regression-test	only runs the tests of RegressionTest.h
+*/
 #include "dcs.h"
-#include "TestSystem.h"
-#include "Timer.h"
-
-void TestAddDefault();
-void TestAddPooling();
-void TestAddCopy();
-void TestRemove();
-void TestDelete();
-void TestUpdate();
-void TestRandomAccess();
-
-TestSystem testSystem;
-
-int amountOfComponents = 100000;
-int amountOfTests = 100;
-
-int main()
+#include "Benchmark.h"
+#include "ParallelReadTest.h"
+#include "RegressionTest.h"
+#include "PodTestComponent.h"
+#include "T2C.h"
+#include "TestComponent.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC sees the malloc and free below inlined next to new and delete expressions and warns about the pairing.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Every allocation of the program passes through here so --counters can count them.
+void* operator new(size_t size)
 {
-	Timer addDefault = Timer("Add Default");
-	Timer removeWithID = Timer("Remove");
-	Timer addFromPool = Timer("Add From Pool");
-	Timer deleteComponent = Timer("Delete");
-	Timer passCopyTimer = Timer("Construct Copy");
-	Timer updateTimer = Timer("Update");
-	Timer randomAccessTimer = Timer("Random Access");
-
-
-	testSystem.reserveComponentCapacity(amountOfComponents);
-	testSystem.reserveIDCapacity(amountOfComponents);
-	for (int i = 0; i < amountOfTests; i++)
+	AllocationCounter::record(size);
+	void* memory = std::malloc(size != 0 ? size : 1);
+	if (memory == nullptr)
 	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
 
-		passCopyTimer.Start();
-		TestAddCopy();
-		passCopyTimer.Stop();
-
-		deleteComponent.Start();
-		TestDelete();
-		deleteComponent.Stop();
-
-		decs::World::destroyOrphanedEntities();
-		decs::World::destroyMarked();
-
-		addDefault.Start();
-		TestAddDefault();
-		addDefault.Stop();
-
-		removeWithID.Start();
-		TestRemove();
-		removeWithID.Stop();
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
 
-		addFromPool.Start();
-		TestAddPooling();
-		addFromPool.Stop();
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
 
-		updateTimer.Start();
-		TestUpdate();
-		updateTimer.Stop();
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
 
-		randomAccessTimer.Start();
-		TestRandomAccess();
-		randomAccessTimer.Stop();
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
 
-		decs::World::destroyAllEntities(false);
-		decs::World::destroyMarked();
-		testSystem.clear();
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
 
+// std::pmr::new_delete_resource, which decs allocates from by default, uses the aligned forms.
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	AllocationCounter::record(size);
+	size_t align = static_cast<size_t>(alignment);
 
-		std::cout << "finished iter: " << i << std::endl;
+	// Room to align the block and to keep the pointer malloc returned just in front of it.
+	void* memory = std::malloc(size + align + sizeof(void*));
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
 	}
-	addDefault.PrintResults();
-	removeWithID.PrintResults();
-	addFromPool.PrintResults();
-	deleteComponent.PrintResults();
-	passCopyTimer.PrintResults();
-	updateTimer.PrintResults();
-	randomAccessTimer.PrintResults();
-
-
-	system("pause");
+	std::uintptr_t block = (reinterpret_cast<std::uintptr_t>(memory) + sizeof(void*) + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+	reinterpret_cast<void**>(block)[-1] = memory;
+	return reinterpret_cast<void*>(block);
 }
 
-void TestAddDefault()
+void* operator new[](size_t size, std::align_val_t alignment)
 {
-	for (int i = 0; i < amountOfComponents; i++)
-	{
-		testSystem.addComponentWithID(decs::World::createNewID());
-	}
+	return operator new(size, alignment);
 }
 
-void TestAddPooling()
+void operator delete(void* memory, std::align_val_t) noexcept
 {
-	for (int i = 0; i < amountOfComponents; i++)
+	if (memory != nullptr)
 	{
-		// We know the ids are between 0 & 99999
-		testSystem.addComponentWithID(i);
+		std::free(static_cast<void**>(memory)[-1]);
 	}
+}
 
+void operator delete[](void* memory, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
 }
 
-void TestAddCopy()
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept
 {
-	for (int i = 0; i < amountOfComponents; i++)
-	{
-		TestComponent copy;
-		testSystem.addComponentValuesWithID(decs::World::createNewID(), copy);
-	}
+	operator delete(memory, alignment);
 }
 
-void TestRemove()
+void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept
 {
-	for (int i = 0; i < amountOfComponents; i++)
-	{
-		testSystem.removeAllComponentsWithID(i);
-	}
+	operator delete(memory, alignment);
 }
 
-void TestDelete()
+template<class T>
+void RunSweep(Benchmark& benchmark, const char* name, const std::vector<int>& counts, BenchmarkConfig config);
+
+int main(int argc, char* argv[])
 {
-	for (int i = 0; i < amountOfComponents; i++)
+	std::vector<int> counts = { 1000, 10000, 100000, 1000000 };
+	BenchmarkConfig config;
+	config.threads = std::thread::hardware_concurrency();
+	Benchmark benchmark;
+	const char* jsonPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
 	{
-		testSystem.destroyAllComponentsWithID(i);
+		bool hasValue = i + 1 < argc;
+		if (std::strcmp(argv[i], "--quick") == 0)
+		{
+			counts = { 1000, 10000 };
+		}
+		else if (std::strcmp(argv[i], "--full") == 0)
+		{
+			counts = { 1000, 10000, 100000, 1000000, 10000000 };
+		}
+		else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue)
+		{
+			config.repetitions = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+		{
+			config.threads = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--memory") == 0 && hasValue)
+		{
+			benchmark.memoryBudget = std::atoll(argv[++i]) * 1024 * 1024;
+		}
+		else if (std::strcmp(argv[i], "--counters") == 0)
+		{
+			benchmark.instrument = true;
+		}
+		else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+		{
+			jsonPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--parallel-read-test") == 0)
+		{
+			return RunParallelReadTest(std::cout) ? 0 : 1;
+		}
+		else if (std::strcmp(argv[i], "--regression-test") == 0)
+		{
+			return RunRegressionTests(std::cout) ? 0 : 1;
+		}
+		else
+		{
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+			return 1;
+		}
 	}
-}
 
+	RunSweep<T2C>(benchmark, "T2C", counts, config);
+	RunSweep<PodTestComponent>(benchmark, "PodTestComponent", counts, config);
+	RunSweep<TestComponent>(benchmark, "TestComponent", counts, config);
 
-void TestUpdate()
-{
-	testSystem.update();
+	benchmark.PrintResults(std::cout);
+
+	if (jsonPath != nullptr && std::strcmp(jsonPath, "-") == 0)
+	{
+		benchmark.WriteJson(std::cout);
+	}
+	else if (jsonPath != nullptr)
+	{
+		std::ofstream file(jsonPath);
+		benchmark.WriteJson(file);
+	}
+
+#ifdef _WIN32
+	system("pause");
+#endif
+	return 0;
 }
 
-void TestRandomAccess()
+template<class T>
+void RunSweep(Benchmark& benchmark, const char* name, const std::vector<int>& counts, BenchmarkConfig config)
 {
-	for (int i = 0; i < amountOfComponents; i++)
+	for (int count : counts)
 	{
-		testSystem.getPtrComponentWithID(i);
+		for (int perID : { 1, 4 })
+		{
+			config.components = count;
+			config.componentsPerID = perID;
+			if (!benchmark.Run<T>(name, config))
+			{
+				std::cerr << "Skipped " << name << " x" << count << " x" << perID << ": over the memory budget" << std::endl;
+				continue;
+			}
+			std::cerr << "Finished " << name << " x" << count << " x" << perID << std::endl;
+		}
 	}
-}
\ No newline at end of file
+}
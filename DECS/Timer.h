@@ -2,13 +2,21 @@
 	Created by Paul O'Callaghan
 */
 #pragma once
-#include <iostream>
+#include <algorithm>
 #include <chrono>
-
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Times repeated runs of one benchmark phase with steady_clock in nanoseconds.
+/// Each Start/Stop pair is one sample, operations is the number of operations
+/// one sample performs and is used for ns/op.
+/// </summary>
 class Timer
 {
 public:
-	Timer(std::string s);
+	Timer(std::string s, long long operations = 1);
 	~Timer();
 
 	void Start();
@@ -16,104 +24,113 @@ public:
 
 	void PrintResults();
 
-	void SetSlowest(std::chrono::microseconds time);
-	void SetFastest(std::chrono::microseconds time);
-	void SetAverage();
-	std::string name = "";
-private:
+	/// <summary>
+	/// Returns the sample at percentile p, 0 to 100, using the nearest rank.
+	/// </summary>
+	long long Percentile(double p);
 
-	std::chrono::time_point<std::chrono::system_clock> start;
-	std::chrono::time_point<std::chrono::system_clock> end;
+	long long Fastest();
+	long long Slowest();
+	long long Mean();
 
-	std::chrono::microseconds fastest;
-	std::chrono::microseconds slowest;
-	long long average;
+	/// <summary>
+	/// Median sample divided by the operations of one sample.
+	/// </summary>
+	double NanosecondsPerOperation();
 
-	std::vector<std::chrono::microseconds> times = std::vector<std::chrono::microseconds>();
+	int SampleCount();
 
-	bool firstFastestSet = false;
-	bool firstSlowestSet = false;
+	std::string name = "";
+	long long operations = 1;
+private:
+
+	std::chrono::steady_clock::time_point start;
+
+	std::vector<long long> times = std::vector<long long>();
+	std::vector<long long> sorted = std::vector<long long>();
 };
 
-Timer::Timer(std::string s)
+inline Timer::Timer(std::string s, long long operations)
+	: name(s), operations(std::max(operations, 1LL))
 {
-	name = s;
 }
 
-Timer::~Timer()
+inline Timer::~Timer()
 {
 }
 
-void Timer::Start()
+inline void Timer::Start()
 {
-	start = std::chrono::system_clock::now();
+	start = std::chrono::steady_clock::now();
 }
 
-void Timer::Stop()
+inline void Timer::Stop()
 {
-	end = std::chrono::system_clock::now();
-	auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-	SetFastest(microseconds);
-	SetSlowest(microseconds);
-	times.push_back(microseconds);
+	auto end = std::chrono::steady_clock::now();
+	times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	sorted.clear();
 }
 
 inline void Timer::PrintResults()
 {
 	std::cout << "======" << name << "=====" << std::endl;
 
-	std::cout << "Fastest: " << fastest.count() << " ns" << std::endl;
+	std::cout << "Fastest: " << Fastest() << " ns" << std::endl;
 
-	std::cout << "Slowest: " << slowest.count() << " ns" << std::endl;
+	std::cout << "Slowest: " << Slowest() << " ns" << std::endl;
 
-	SetAverage();
-	std::cout << "Mean: " << average << " ns" << std::endl;
-	std::cout << std::endl;
+	std::cout << "Mean: " << Mean() << " ns" << std::endl;
+	std::cout << "p50: " << Percentile(50) << " ns, p90: " << Percentile(90) << " ns, p99: " << Percentile(99) << " ns" << std::endl;
+	std::cout << "Per operation: " << NanosecondsPerOperation() << " ns" << std::endl;
 	std::cout << std::endl;
 }
 
-void Timer::SetFastest(std::chrono::microseconds time)
+inline long long Timer::Percentile(double p)
 {
-	if (!firstFastestSet)
+	if (times.empty())
 	{
-		fastest = time;
-		firstFastestSet = true;
-		return;
+		return 0;
 	}
-
-	if (time.count() < fastest.count())
+	if (sorted.empty())
 	{
-		fastest = time;
+		sorted = times;
+		std::sort(sorted.begin(), sorted.end());
 	}
+	size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+	rank = std::min(std::max(rank, static_cast<size_t>(1)), sorted.size());
+	return sorted[rank - 1];
+}
 
+inline long long Timer::Fastest()
+{
+	return Percentile(0);
 }
 
+inline long long Timer::Slowest()
+{
+	return Percentile(100);
+}
 
-void Timer::SetSlowest(std::chrono::microseconds time)
+inline long long Timer::Mean()
 {
-	if (!firstSlowestSet)
+	if (times.empty())
 	{
-		slowest = time;
-		firstSlowestSet = true;
-		return;
+		return 0;
 	}
-
-	if (time.count() > slowest.count())
+	long long total = 0;
+	for (long long time : times)
 	{
-		slowest = time;
+		total += time;
 	}
+	return total / static_cast<long long>(times.size());
 }
 
-void Timer::SetAverage()
+inline double Timer::NanosecondsPerOperation()
 {
-	std::chrono::microseconds time = std::chrono::duration_cast<std::chrono::microseconds>(times.at(0));
-	int j = 1;
+	return static_cast<double>(Percentile(50)) / operations;
+}
 
-	for (int i = 1; i < times.size(); i++)
-	{
-		time = std::chrono::duration_cast<std::chrono::microseconds>(time + times.at(i));
-		++j;
-	}
-	average = time.count() / j;
+inline int Timer::SampleCount()
+{
+	return static_cast<int>(times.size());
 }
@@ -13,1511 +13,9163 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <deque>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 #include <type_traits>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DECS_SSE2
+#endif
+
+namespace decs
+{
+	/// <summary>
+	/// Memory resource used by every container inside decs: component dense lists, sparse indexes,
+	/// the signature and counter tables and the World's id pools, systems and command buffers.
+	/// Defaults to the global heap.
+	/// 
+	/// Set the resource before any system, component or id is created. Memory is given back to the
+	/// resource that is current when it is freed, so swapping resources while containers hold memory
+	/// would hand blocks to a resource that didn't allocate them. MonotonicArena and BlockPool detach
+	/// themselves when destroyed, after which freeing does nothing and allocating throws std::bad_alloc.
+	/// A resource destroyed while still in use keeps its region so the decs statics destroyed after it
+	/// at exit can still read their blocks.
+	/// </summary>
+	class Memory
+	{
+	public:
+		/// <summary>
+		/// Returns the resource decs containers currently allocate from.
+		/// </summary>
+		static std::pmr::memory_resource* resource();
+
+		/// <summary>
+		/// Sets the resource decs containers allocate from. nullptr restores the global heap.
+		/// </summary>
+		/// <param name="newResource">Resource to allocate from. Must outlive every decs container or detach itself.</param>
+		/// <returns>The resource that was in use.</returns>
+		static std::pmr::memory_resource* setResource(std::pmr::memory_resource* newResource);
+
+		/// <summary>
+		/// Called by a resource being destroyed. If it is the current resource decs switches to
+		/// std::pmr::null_memory_resource so freeing the remaining blocks does nothing.
+		/// </summary>
+		/// <param name="destroyed">Resource being destroyed.</param>
+		/// <returns>True if the resource was in use, its memory should then be left allocated.</returns>
+		static bool detach(std::pmr::memory_resource* destroyed);
+
+	private:
+		// nullptr stands for the global heap so the pointer is constant initialised.
+		inline static std::atomic<std::pmr::memory_resource*> current{ nullptr };
+	};
+
+	inline std::pmr::memory_resource* Memory::resource()
+	{
+		std::pmr::memory_resource* inUse = current.load(std::memory_order_relaxed);
+		return inUse != nullptr ? inUse : std::pmr::new_delete_resource();
+	}
+
+	inline std::pmr::memory_resource* Memory::setResource(std::pmr::memory_resource* newResource)
+	{
+		std::pmr::memory_resource* previous = current.exchange(newResource);
+		return previous != nullptr ? previous : std::pmr::new_delete_resource();
+	}
+
+	inline bool Memory::detach(std::pmr::memory_resource* destroyed)
+	{
+		std::pmr::memory_resource* expected = destroyed;
+		return current.compare_exchange_strong(expected, std::pmr::null_memory_resource());
+	}
+
+	/// <summary>
+	/// Stateless allocator that forwards to Memory::resource(). Every instance compares equal so
+	/// containers can swap and move storage freely.
+	/// </summary>
+	/// <typeparam name="T">Type to allocate.</typeparam>
+	template<class T>
+	class Allocator
+	{
+	public:
+		typedef T value_type;
+
+		Allocator() noexcept {}
+
+		template<class U>
+		Allocator(const Allocator<U>&) noexcept {}
+
+		T* allocate(size_t n)
+		{
+			return static_cast<T*>(Memory::resource()->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, size_t n)
+		{
+			Memory::resource()->deallocate(p, n * sizeof(T), alignof(T));
+		}
+
+		template<class U>
+		bool operator==(const Allocator<U>&) const noexcept
+		{
+			return true;
+		}
+
+		template<class U>
+		bool operator!=(const Allocator<U>&) const noexcept
+		{
+			return false;
+		}
+	};
+
+	/// <summary>
+	/// std::vector allocating through Memory::resource().
+	/// </summary>
+	template<class T>
+	using Vector = std::vector<T, Allocator<T>>;
+
+	/// <summary>
+	/// std::deque allocating through Memory::resource().
+	/// </summary>
+	template<class T>
+	using Deque = std::deque<T, Allocator<T>>;
+
+	/// <summary>
+	/// Size of a cache line in bytes.
+	/// </summary>
+	constexpr size_t cacheLineSize = 64;
+
+	/// <summary>
+	/// Allocator that forwards to Memory::resource() like Allocator but starts every block on a cache
+	/// line, so a parallel update can cut the dense lists of components on line boundaries.
+	/// </summary>
+	/// <typeparam name="T">Type to allocate.</typeparam>
+	template<class T>
+	class CacheLineAllocator
+	{
+	public:
+		typedef T value_type;
+
+		CacheLineAllocator() noexcept {}
+
+		template<class U>
+		CacheLineAllocator(const CacheLineAllocator<U>&) noexcept {}
+
+		T* allocate(size_t n)
+		{
+			return static_cast<T*>(Memory::resource()->allocate(n * sizeof(T), alignment));
+		}
+
+		void deallocate(T* p, size_t n)
+		{
+			Memory::resource()->deallocate(p, n * sizeof(T), alignment);
+		}
+
+		template<class U>
+		bool operator==(const CacheLineAllocator<U>&) const noexcept
+		{
+			return true;
+		}
+
+		template<class U>
+		bool operator!=(const CacheLineAllocator<U>&) const noexcept
+		{
+			return false;
+		}
+
+	private:
+		static constexpr size_t alignment = std::max(alignof(T), cacheLineSize);
+	};
+
+	/// <summary>
+	/// std::vector allocating cache line aligned blocks through Memory::resource().
+	/// </summary>
+	template<class T>
+	using AlignedVector = std::vector<T, CacheLineAllocator<T>>;
+
+	/// <summary>
+	/// Bump allocator over one region reserved up front. Freeing a block does nothing, release()
+	/// makes the whole region available again in O(1). Requests that don't fit go to upstream,
+	/// pass std::pmr::null_memory_resource() to make running out throw std::bad_alloc instead.
+	/// Blocks freed that don't belong to the region are given to upstream as well.
+	/// Safe to allocate from several threads at once.
+	/// 
+	/// A Registry built while the arena is the resource is torn down without per component work by
+	/// destroying it and calling release(): freeing its blocks costs nothing here and trivially
+	/// destructible components are never visited. Registry::reset drops the components the same way
+	/// but can't release the region, as the systems, groups and command buffers the registry keeps
+	/// still have blocks in it, so blocks dropped by a reset stay used until the next release().
+	/// </summary>
+	class MonotonicArena : public std::pmr::memory_resource
+	{
+	public:
+		/// <param name="bytes">Size of the region to reserve.</param>
+		/// <param name="upstream">Resource used once the region is full.</param>
+		MonotonicArena(size_t bytes, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+		~MonotonicArena();
+
+		MonotonicArena(const MonotonicArena&) = delete;
+		MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+		/// <summary>
+		/// Makes the whole region available again. Only call once nothing uses memory from it.
+		/// </summary>
+		void release();
+
+		/// <summary>
+		/// Returns the number of bytes handed out from the region, including alignment padding.
+		/// </summary>
+		size_t used() const;
+
+		/// <summary>
+		/// Returns the size of the region.
+		/// </summary>
+		size_t capacity() const;
+
+	private:
+		char* region;
+		size_t regionSize;
+		std::atomic<size_t> offset;
+		std::pmr::memory_resource* upstream;
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+	};
+
+	inline MonotonicArena::MonotonicArena(size_t bytes, std::pmr::memory_resource* upstream)
+		: region(static_cast<char*>(::operator new(bytes))), regionSize(bytes), offset(0), upstream(upstream)
+	{
+
+	}
+
+	inline MonotonicArena::~MonotonicArena()
+	{
+		if (!Memory::detach(this))
+		{
+			::operator delete(region);
+		}
+	}
+
+	inline void MonotonicArena::release()
+	{
+		offset.store(0);
+	}
+
+	inline size_t MonotonicArena::used() const
+	{
+		return offset.load();
+	}
+
+	inline size_t MonotonicArena::capacity() const
+	{
+		return regionSize;
+	}
+
+	inline void* MonotonicArena::do_allocate(size_t bytes, size_t alignment)
+	{
+		std::uintptr_t base = reinterpret_cast<std::uintptr_t>(region);
+		size_t current = offset.load(std::memory_order_relaxed);
+		while (true)
+		{
+			size_t start = ((base + current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) - base;
+			if (start + bytes > regionSize)
+			{
+				return upstream->allocate(bytes, alignment);
+			}
+			if (offset.compare_exchange_weak(current, start + bytes, std::memory_order_relaxed))
+			{
+				return region + start;
+			}
+		}
+	}
+
+	inline void MonotonicArena::do_deallocate(void* p, size_t bytes, size_t alignment)
+	{
+		char* block = static_cast<char*>(p);
+		if (block < region || block >= region + regionSize)
+		{
+			upstream->deallocate(p, bytes, alignment);
+		}
+	}
+
+	inline bool MonotonicArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	/// <summary>
+	/// Pool of equally sized blocks carved from one region reserved up front. Freed blocks are reused
+	/// first. Requests bigger than a block, with a stricter alignment than std::max_align_t, or made
+	/// once every block is in use go to upstream. Pairs well with ChunkedStorage, whose chunks are all
+	/// the same size. release() makes every block available again in O(1).
+	/// Safe to allocate from several threads at once.
+	/// </summary>
+	class BlockPool : public std::pmr::memory_resource
+	{
+	public:
+		/// <param name="blockSize">Size of each block in bytes. Rounded up to a multiple of alignof(std::max_align_t).</param>
+		/// <param name="blockCount">Number of blocks to reserve.</param>
+		/// <param name="upstream">Resource used for requests the pool can't serve.</param>
+		BlockPool(size_t blockSize, size_t blockCount, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+		~BlockPool();
+
+		BlockPool(const BlockPool&) = delete;
+		BlockPool& operator=(const BlockPool&) = delete;
+
+		/// <summary>
+		/// Makes every block available again. Only call once nothing uses memory from the pool.
+		/// </summary>
+		void release();
+
+		/// <summary>
+		/// Returns the size of each block.
+		/// </summary>
+		size_t blockSize() const;
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		char* region;
+		size_t size;
+		size_t count;
+		size_t nextUnused;
+		FreeBlock* freeList;
+		std::mutex poolMutex;
+		std::pmr::memory_resource* upstream;
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+	};
+
+	inline BlockPool::BlockPool(size_t blockSize, size_t blockCount, std::pmr::memory_resource* upstream)
+		: region(nullptr), size(0), count(blockCount), nextUnused(0), freeList(nullptr), upstream(upstream)
+	{
+		const size_t alignment = alignof(std::max_align_t);
+		size = (std::max(blockSize, sizeof(FreeBlock)) + alignment - 1) / alignment * alignment;
+		region = static_cast<char*>(::operator new(size * count));
+	}
+
+	inline BlockPool::~BlockPool()
+	{
+		if (!Memory::detach(this))
+		{
+			::operator delete(region);
+		}
+	}
+
+	inline void BlockPool::release()
+	{
+		std::lock_guard<std::mutex> lock(poolMutex);
+		nextUnused = 0;
+		freeList = nullptr;
+	}
+
+	inline size_t BlockPool::blockSize() const
+	{
+		return size;
+	}
+
+	inline void* BlockPool::do_allocate(size_t bytes, size_t alignment)
+	{
+		if (bytes <= size && alignment <= alignof(std::max_align_t))
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			if (freeList != nullptr)
+			{
+				FreeBlock* block = freeList;
+				freeList = block->next;
+				return block;
+			}
+			if (nextUnused < count)
+			{
+				return region + size * nextUnused++;
+			}
+		}
+		return upstream->allocate(bytes, alignment);
+	}
+
+	inline void BlockPool::do_deallocate(void* p, size_t bytes, size_t alignment)
+	{
+		char* block = static_cast<char*>(p);
+		if (block < region || block >= region + size * count)
+		{
+			upstream->deallocate(p, bytes, alignment);
+			return;
+		}
+		std::lock_guard<std::mutex> lock(poolMutex);
+		FreeBlock* freed = ::new (p) FreeBlock;
+		freed->next = freeList;
+		freeList = freed;
+	}
+
+	inline bool BlockPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+} // End Memory
+
+namespace decs
+{
+	/// <summary>
+	/// Writes count values as raw bytes. Snapshots are written with these, so they can only be read
+	/// back by a build with the same type layouts and byte order.
+	/// </summary>
+	template<class V>
+	inline void writeRaw(std::ostream& out, const V* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Only trivially copyable values can be written as bytes");
+		if (count > 0)
+		{
+			out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(V)));
+		}
+	}
+
+	/// <summary>
+	/// Reads count values written by writeRaw.
+	/// </summary>
+	/// <returns>False if the stream ended or failed.</returns>
+	template<class V>
+	inline bool readRaw(std::istream& in, V* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Only trivially copyable values can be read as bytes");
+		if (count > 0)
+		{
+			in.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(V)));
+		}
+		return !in.fail();
+	}
+
+	/// <summary>
+	/// Number of values the readers below add to a list at a time, about a megabyte. Lists grow as their
+	/// values arrive, so a corrupt size fails at the end of the stream instead of allocating all it claims.
+	/// </summary>
+	template<class V>
+	constexpr size_t readStep()
+	{
+		return sizeof(V) >= (1 << 20) ? 1 : (1 << 20) / sizeof(V);
+	}
+
+	template<class V>
+	inline void writeValue(std::ostream& out, const V& value)
+	{
+		writeRaw(out, &value, 1);
+	}
+
+	template<class V>
+	inline bool readValue(std::istream& in, V& value)
+	{
+		return readRaw(in, &value, 1);
+	}
+
+	/// <summary>
+	/// Writes the size of list followed by its elements.
+	/// </summary>
+	template<class V, class Allocator>
+	inline void writeList(std::ostream& out, const std::vector<V, Allocator>& list)
+	{
+		writeValue(out, static_cast<std::uint64_t>(list.size()));
+		writeRaw(out, list.data(), list.size());
+	}
+
+	/// <summary>
+	/// Replaces list with one written by writeList. Sizes no int can index are refused.
+	/// </summary>
+	/// <returns>False if the stream ended, failed or holds an impossible size.</returns>
+	template<class V, class Allocator>
+	inline bool readList(std::istream& in, std::vector<V, Allocator>& list)
+	{
+		std::uint64_t size;
+		if (!readValue(in, size) || size > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+		{
+			return false;
+		}
+		list.clear();
+		for (size_t position = 0; position < size; position += readStep<V>())
+		{
+			size_t length = std::min(readStep<V>(), static_cast<size_t>(size) - position);
+			list.resize(position + length);
+			if (!readRaw(in, list.data() + position, length))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // End Binary
+
+namespace decs
+{
+	/// <summary>
+	/// Paged index mapping IDs to positions in a dense list. IDs are grouped into fixed size pages
+	/// that are only allocated once an ID in that page is used, so a large ID range costs one empty
+	/// list per page until it is populated.
+	/// 
+	/// Each ID owns a single int slot. An ID with one component stores its dense position directly in
+	/// that slot. An ID with more than one component stores a tagged index into an overflow table
+	/// which keeps its dense positions sorted, closest to the beginning of the dense list first.
+	/// 
+	/// Changing a position is O(1) for an id with one component. For an id with k components it is
+	/// a binary search plus shifting up to k entries of its list, which keeps first() the lowest
+	/// position as Groups and the active range need. A dense to list index back-pointer would only
+	/// replace the search, since every shifted entry would need its back-pointer rewritten.
+	/// </summary>
+	class SparseIndex
+	{
+	public:
+		static const int page_shift = 12;
+		static const int page_size = 1 << page_shift;
+		static const int page_mask = page_size - 1;
+		static const int empty_slot = -1;
+
+		/// <summary>
+		/// Makes sure the page table can address ids in the range [0, u). Pages themselves are
+		/// allocated on first use.
+		/// </summary>
+		/// <param name="u">Number of ids to be addressable.</param>
+		void resize(int u);
+
+		/// <summary>
+		/// Frees all pages and overflow lists.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Writes the page table and overflow lists. Pages that were never allocated only take a flag.
+		/// </summary>
+		void write(std::ostream& out) const;
+
+		/// <summary>
+		/// Replaces the index with one written by write.
+		/// </summary>
+		/// <returns>False if the stream ended or failed.</returns>
+		bool read(std::istream& in);
+
+		/// <summary>
+		/// Checks an index loaded by read against the dense list it was written with. Every id below
+		/// capacity needs a page, ids at or past it no positions, each position below used exactly one
+		/// id that owns it, overflow lists must be sorted and held by one id or free and empty.
+		/// </summary>
+		/// <param name="used">Number of dense positions in use.</param>
+		/// <param name="capacity">Number of ids the index has to address.</param>
+		/// <param name="ownerOf">Returns the id owning a dense position below used.</param>
+		/// <returns>True if every slot and overflow list is consistent with the dense list.</returns>
+		template<class OwnerOf>
+		bool validate(int used, int capacity, OwnerOf ownerOf) const;
+
+		/// <summary>
+		/// Checks if id has at least one dense position. Id must be smaller than the size passed to resize.
+		/// </summary>
+		/// <param name="id">ID to check.</param>
+		/// <returns>True if id has a position, false otherwise.</returns>
+		bool contains(const int id) const;
+
+		/// <summary>
+		/// Returns the number of dense positions stored for id.
+		/// </summary>
+		/// <param name="id">ID to check.</param>
+		/// <returns>Number of dense positions belonging to id.</returns>
+		int count(const int id) const;
+
+		/// <summary>
+		/// Returns the dense position closest to the beginning of the dense list for id.
+		/// Results in undefined behaviour if id has no position.
+		/// </summary>
+		/// <param name="id">ID to look up.</param>
+		/// <returns>Dense position.</returns>
+		int first(const int id) const;
+
+		/// <summary>
+		/// Returns the dense position at index relative to id. Results in undefined behaviour if
+		/// index is out of range.
+		/// </summary>
+		/// <param name="id">ID to look up.</param>
+		/// <param name="index">Index of position relative to id.</param>
+		/// <returns>Dense position.</returns>
+		int at(const int id, const int index) const;
+
+		/// <summary>
+		/// Adds a dense position to id. Position must be greater than any position already held by id.
+		/// </summary>
+		/// <param name="id">ID to add position to.</param>
+		/// <param name="position">Dense position to add.</param>
+		void push(const int id, const int position);
+
+		/// <summary>
+		/// Replaces the last (highest) dense position of id and keeps the positions of id sorted.
+		/// </summary>
+		/// <param name="id">ID to update.</param>
+		/// <param name="position">New dense position.</param>
+		void replaceLast(const int id, const int position);
+
+		/// <summary>
+		/// Replaces dense position from of id with to and keeps the positions of id sorted.
+		/// </summary>
+		/// <param name="id">ID to update.</param>
+		/// <param name="from">Dense position held by id.</param>
+		/// <param name="to">New dense position.</param>
+		void replace(const int id, const int from, const int to);
+
+		/// <summary>
+		/// Returns the index relative to id of dense position. Results in undefined
+		/// behaviour if id does not hold position.
+		/// </summary>
+		/// <param name="id">ID to look up.</param>
+		/// <param name="position">Dense position held by id.</param>
+		/// <returns>Index of position relative to id.</returns>
+		int indexOf(const int id, const int position) const;
+
+		/// <summary>
+		/// Removes the dense position at index relative to id.
+		/// </summary>
+		/// <param name="id">ID to update.</param>
+		/// <param name="index">Index of position relative to id.</param>
+		void erase(const int id, const int index);
+
+	private:
+		Vector<Vector<int>> pages;
+		Vector<Vector<int>> overflow;
+		Vector<int> freeOverflow;
+
+		/// <summary>
+		/// Returns the slot of id, allocating its page if it does not exist yet.
+		/// </summary>
+		int& slot(const int id);
+
+		/// <summary>
+		/// Returns the slot value of id or empty_slot if its page has not been allocated.
+		/// </summary>
+		int peek(const int id) const;
+
+		/// <summary>
+		/// Overflow list indices are stored in slots as negative values below empty_slot.
+		/// </summary>
+		static int encodeOverflow(int index);
+		static int decodeOverflow(int value);
+	};
+
+	inline void SparseIndex::resize(int u)
+	{
+		size_t pageCount = (static_cast<size_t>(u) + page_mask) >> page_shift;
+		if (pageCount > pages.size())
+		{
+			pages.resize(pageCount);
+		}
+	}
+
+	inline void SparseIndex::clear()
+	{
+		pages.clear();
+		overflow.clear();
+		freeOverflow.clear();
+	}
+
+	inline void SparseIndex::write(std::ostream& out) const
+	{
+		writeValue(out, static_cast<std::uint64_t>(pages.size()));
+		for (const Vector<int>& page : pages)
+		{
+			std::uint8_t allocated = page.empty() ? 0 : 1;
+			writeValue(out, allocated);
+			writeRaw(out, page.data(), page.size());
+		}
+		writeValue(out, static_cast<std::uint64_t>(overflow.size()));
+		for (const Vector<int>& positions : overflow)
+		{
+			writeList(out, positions);
+		}
+		writeList(out, freeOverflow);
+	}
+
+	inline bool SparseIndex::read(std::istream& in)
+	{
+		clear();
+		std::uint64_t pageCount;
+		if (!readValue(in, pageCount) || pageCount > (static_cast<std::uint64_t>(std::numeric_limits<int>::max()) >> page_shift) + 1)
+		{
+			return false;
+		}
+		pages.resize(static_cast<size_t>(pageCount));
+		for (Vector<int>& page : pages)
+		{
+			std::uint8_t allocated;
+			if (!readValue(in, allocated))
+			{
+				return false;
+			}
+			if (allocated != 0)
+			{
+				page.resize(page_size);
+				if (!readRaw(in, page.data(), page.size()))
+				{
+					return false;
+				}
+			}
+		}
+		std::uint64_t overflowCount;
+		if (!readValue(in, overflowCount) || overflowCount > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+		{
+			return false;
+		}
+		for (std::uint64_t i = 0; i < overflowCount; i++)
+		{
+			overflow.emplace_back();
+			if (!readList(in, overflow.back()))
+			{
+				return false;
+			}
+		}
+		return readList(in, freeOverflow);
+	}
+
+	template<class OwnerOf>
+	inline bool SparseIndex::validate(int used, int capacity, OwnerOf ownerOf) const
+	{
+		if (used < 0 || capacity < 0 || pages.size() < ((static_cast<size_t>(capacity) + page_mask) >> page_shift))
+		{
+			return false;
+		}
+
+		// Each overflow list may be claimed once, either by the free list or by one id.
+		Vector<std::uint8_t> claimed(overflow.size(), 0);
+		for (int overflowIndex : freeOverflow)
+		{
+			if (overflowIndex < 0 || static_cast<size_t>(overflowIndex) >= overflow.size()
+				|| claimed[overflowIndex] != 0 || !overflow[overflowIndex].empty())
+			{
+				return false;
+			}
+			claimed[overflowIndex] = 1;
+		}
+
+		long long positions = 0;
+		for (size_t page = 0; page < pages.size(); page++)
+		{
+			for (size_t offset = 0; offset < pages[page].size(); offset++)
+			{
+				int value = pages[page][offset];
+				if (value == empty_slot)
+				{
+					continue;
+				}
+				long long id = (static_cast<long long>(page) << page_shift) + static_cast<long long>(offset);
+				if (id >= capacity)
+				{
+					return false;
+				}
+				if (value >= 0)
+				{
+					if (value >= used || ownerOf(value) != id)
+					{
+						return false;
+					}
+					++positions;
+					continue;
+				}
+
+				int overflowIndex = decodeOverflow(value);
+				if (static_cast<size_t>(overflowIndex) >= overflow.size() || claimed[overflowIndex] != 0)
+				{
+					return false;
+				}
+				claimed[overflowIndex] = 1;
+				const Vector<int>& list = overflow[overflowIndex];
+				if (list.size() < 2)
+				{
+					return false;
+				}
+				for (size_t i = 0; i < list.size(); i++)
+				{
+					if (list[i] < 0 || list[i] >= used || (i > 0 && list[i] <= list[i - 1]) || ownerOf(list[i]) != id)
+					{
+						return false;
+					}
+				}
+				positions += static_cast<long long>(list.size());
+			}
+		}
+		// Positions are owned by the id that holds them, so as many as are in use means each is held once.
+		return positions == used;
+	}
+
+	inline bool SparseIndex::contains(const int id) const
+	{
+		return peek(id) != empty_slot;
+	}
+
+	inline int SparseIndex::count(const int id) const
+	{
+		int value = peek(id);
+		if (value == empty_slot)
+		{
+			return 0;
+		}
+		if (value >= 0)
+		{
+			return 1;
+		}
+		return static_cast<int>(overflow[decodeOverflow(value)].size());
+	}
+
+	inline int SparseIndex::first(const int id) const
+	{
+		int value = pages[id >> page_shift][id & page_mask];
+		if (value >= 0)
+		{
+			return value;
+		}
+		return overflow[decodeOverflow(value)].front();
+	}
+
+	inline int SparseIndex::at(const int id, const int index) const
+	{
+		int value = pages[id >> page_shift][id & page_mask];
+		if (value >= 0)
+		{
+			return value;
+		}
+		return overflow[decodeOverflow(value)][index];
+	}
+
+	inline void SparseIndex::push(const int id, const int position)
+	{
+		int& value = slot(id);
+		if (value == empty_slot)
+		{
+			value = position;
+			return;
+		}
+		if (value < empty_slot)
+		{
+			overflow[decodeOverflow(value)].push_back(position);
+			return;
+		}
+
+		// Second component for this id, move it to the overflow table.
+		int overflowIndex;
+		if (freeOverflow.empty())
+		{
+			overflowIndex = static_cast<int>(overflow.size());
+			overflow.emplace_back();
+		}
+		else
+		{
+			overflowIndex = freeOverflow.back();
+			freeOverflow.pop_back();
+		}
+		Vector<int>& positions = overflow[overflowIndex];
+		positions.push_back(value);
+		positions.push_back(position);
+		value = encodeOverflow(overflowIndex);
+	}
+
+	inline void SparseIndex::replaceLast(const int id, const int position)
+	{
+		int& value = slot(id);
+		if (value >= 0)
+		{
+			value = position;
+			return;
+		}
+
+		// Insertion step keeps positions sorted, only the last element is out of place.
+		Vector<int>& positions = overflow[decodeOverflow(value)];
+		int i = static_cast<int>(positions.size()) - 1;
+		while (i > 0 && positions[i - 1] > position)
+		{
+			positions[i] = positions[i - 1];
+			--i;
+		}
+		positions[i] = position;
+	}
+
+	inline void SparseIndex::replace(const int id, const int from, const int to)
+	{
+		int& value = slot(id);
+		if (value >= 0)
+		{
+			value = to;
+			return;
+		}
+
+		Vector<int>& positions = overflow[decodeOverflow(value)];
+		int i = static_cast<int>(std::lower_bound(positions.begin(), positions.end(), from) - positions.begin());
+		int last = static_cast<int>(positions.size()) - 1;
+		while (i > 0 && positions[i - 1] > to)
+		{
+			positions[i] = positions[i - 1];
+			--i;
+		}
+		while (i < last && positions[i + 1] < to)
+		{
+			positions[i] = positions[i + 1];
+			++i;
+		}
+		positions[i] = to;
+	}
+
+	inline int SparseIndex::indexOf(const int id, const int position) const
+	{
+		int value = peek(id);
+		if (value >= 0)
+		{
+			return 0;
+		}
+		const Vector<int>& positions = overflow[decodeOverflow(value)];
+		return static_cast<int>(std::lower_bound(positions.begin(), positions.end(), position) - positions.begin());
+	}
+
+	inline void SparseIndex::erase(const int id, const int index)
+	{
+		int& value = slot(id);
+		if (value >= 0)
+		{
+			value = empty_slot;
+			return;
+		}
+
+		int overflowIndex = decodeOverflow(value);
+		Vector<int>& positions = overflow[overflowIndex];
+		positions.erase(positions.begin() + index);
+
+		// Back to a single component, store it inline again.
+		if (positions.size() == 1)
+		{
+			value = positions.front();
+			positions.clear();
+			freeOverflow.push_back(overflowIndex);
+		}
+	}
+
+	inline int& SparseIndex::slot(const int id)
+	{
+		Vector<int>& page = pages[id >> page_shift];
+		if (page.empty())
+		{
+			page.assign(page_size, static_cast<int>(empty_slot));
+		}
+		return page[id & page_mask];
+	}
+
+	inline int SparseIndex::peek(const int id) const
+	{
+		const Vector<int>& page = pages[id >> page_shift];
+		if (page.empty())
+		{
+			return empty_slot;
+		}
+		return page[id & page_mask];
+	}
+
+	inline int SparseIndex::encodeOverflow(int index)
+	{
+		return empty_slot - 1 - index;
+	}
+
+	inline int SparseIndex::decodeOverflow(int value)
+	{
+		return empty_slot - 1 - value;
+	}
+} // End SparseIndex
+
+// Restrict qualifier used on field arrays so update loops only touch the fields a component reads and writes.
+#if defined(_MSC_VER) || defined(__GNUC__) || defined(__clang__)
+#define DECS_RESTRICT __restrict
+#else
+#define DECS_RESTRICT
+#endif
+
+namespace decs
+{
+	class ComponentBase;
+	class Component;
+	template<class T> class PodComponent;
+	template<class T> class System;
+	template<class... Components> class View;
+
+	/// <summary>
+	/// Selects the container used for the dense list of SparseSet<T>. Components use a std::vector<T>
+	/// that allocates cache line aligned blocks through Memory::resource() unless they declare their own
+	/// with a nested Storage alias, for example
+	/// using Storage = decs::SoAStorage<MyComponent, &MyComponent::a, &MyComponent::b>;
+	/// or using Storage = decs::ChunkedStorage<MyComponent>; for pointers that survive growth.
+	/// </summary>
+	/// <typeparam name="T">Component type.</typeparam>
+	template<class T, class = void>
+	struct StorageOf
+	{
+		typedef AlignedVector<T> type;
+	};
+
+	template<class T>
+	struct StorageOf<T, std::void_t<typename T::Storage>>
+	{
+		typedef typename T::Storage type;
+	};
+
+	/// <summary>
+	/// Type of the data member pointed to by a pointer to member.
+	/// </summary>
+	template<class M>
+	struct MemberType;
+
+	template<class C, class F>
+	struct MemberType<F C::*>
+	{
+		typedef F type;
+	};
+
+	/// <summary>
+	/// Returns the size of a class deriving from Base whose only data members are Fields, declared in that order.
+	/// </summary>
+	template<class Base, class... Fields>
+	constexpr size_t listedLayoutSize()
+	{
+		size_t end = sizeof(Base);
+		size_t alignment = alignof(Base);
+		((end = (end + alignof(Fields) - 1) / alignof(Fields) * alignof(Fields) + sizeof(Fields),
+			alignment = std::max(alignment, alignof(Fields))), ...);
+		return (end + alignment - 1) / alignment * alignment;
+	}
+
+	/// <summary>
+	/// Returns the smallest number of consecutive elements of T that fill a whole number of cache lines.
+	/// </summary>
+	template<class T>
+	constexpr int cacheLineStride()
+	{
+		// Lines are a power of two long, so only the power of two part of sizeof(T) shares factors with them.
+		return static_cast<int>(cacheLineSize / std::min(sizeof(T) & (~sizeof(T) + 1), cacheLineSize));
+	}
+
+	/// <summary>
+	/// Returns the number of elements a range of list has to be a multiple of for it to start and end
+	/// on cache lines, given list was allocated by CacheLineAllocator.
+	/// </summary>
+	template<class T, class Allocator>
+	constexpr int cacheLineStride(const std::vector<T, Allocator>&)
+	{
+		return cacheLineStride<T>();
+	}
+
+	/// <summary>
+	/// Calls function on every element of list in the range [begin, end).
+	/// </summary>
+	template<class T, class Allocator, class Function>
+	inline void forEachInRange(std::vector<T, Allocator>& list, int begin, int end, Function function)
+	{
+		T* data = list.data();
+		for (int i = begin; i < end; i++)
+		{
+			function(data[i]);
+		}
+	}
+
+	/// <summary>
+	/// Calls function with references to Fields of every element of list in the range [begin, end).
+	/// </summary>
+	template<auto... Fields, class T, class Allocator, class Function>
+	inline void forEachFieldInRange(std::vector<T, Allocator>& list, int begin, int end, Function function)
+	{
+		T* data = list.data();
+		for (int i = begin; i < end; i++)
+		{
+			function((data[i].*Fields)...);
+		}
+	}
+
+	/// <summary>
+	/// Returns the id of the element of list at position.
+	/// </summary>
+	template<class T, class Allocator>
+	inline int belongsToIDAt(std::vector<T, Allocator>& list, int position)
+	{
+		return list[position].belongsToID();
+	}
+
+	/// <summary>
+	/// Returns whether the element of list at position is active.
+	/// </summary>
+	template<class T, class Allocator>
+	inline bool isActiveAt(std::vector<T, Allocator>& list, int position)
+	{
+		return list[position].isActive();
+	}
+
+	/// <summary>
+	/// Move assigns the element of list at from to the element at to.
+	/// </summary>
+	template<class T, class Allocator>
+	inline void moveElement(std::vector<T, Allocator>& list, int from, int to)
+	{
+		list[to] = std::move(list[from]);
+	}
+
+	/// <summary>
+	/// Swaps the elements of list at a and b by moving them.
+	/// </summary>
+	template<class T, class Allocator>
+	inline void swapElements(std::vector<T, Allocator>& list, int a, int b)
+	{
+		std::swap(list[a], list[b]);
+	}
+
+	/// <summary>
+	/// Returns a pointer to the element of list at position.
+	/// </summary>
+	template<class T, class Allocator>
+	inline T* pointerAt(std::vector<T, Allocator>& list, int position)
+	{
+		return list.data() + position;
+	}
+
+	/// <summary>
+	/// Returns the element of list at position for reading only.
+	/// </summary>
+	template<class T, class Allocator>
+	inline const T& readAt(std::vector<T, Allocator>& list, int position)
+	{
+		return list[position];
+	}
+
+	/// <summary>
+	/// True if T declares the snapshot hooks for its own fields:
+	/// void serialize(std::ostream& out) const; and void deserialize(std::istream& in);
+	/// Components with virtual functions or fields that own memory need them.
+	/// </summary>
+	template<class T, class = void>
+	struct HasSerializer : std::false_type {};
+
+	template<class T>
+	struct HasSerializer<T, std::void_t<
+		decltype(std::declval<const T&>().serialize(std::declval<std::ostream&>())),
+		decltype(std::declval<T&>().deserialize(std::declval<std::istream&>()))>> : std::true_type {};
+
+	/// <summary>
+	/// True if components of T can be written to a snapshot, either through the hooks of HasSerializer
+	/// or as raw bytes because T is trivially copyable.
+	/// </summary>
+	template<class T>
+	struct CanSnapshot : std::integral_constant<bool, HasSerializer<T>::value || std::is_trivially_copyable<T>::value> {};
+
+	/// <summary>
+	/// True if T declares the name snapshots know it by: static const char* snapshotName();
+	/// Types without one are named by typeid, whose names differ between compilers and standard libraries,
+	/// so their snapshots only restore in builds made with the same toolchain. Names must be unique.
+	/// </summary>
+	template<class T, class = void>
+	struct HasSnapshotName : std::false_type {};
+
+	template<class T>
+	struct HasSnapshotName<T, std::enable_if_t<std::is_convertible<decltype(T::snapshotName()), const char*>::value>> : std::true_type {};
+
+	/// <summary>
+	/// Writes one component, through its hooks if it has them. The id and active state are written for it.
+	/// </summary>
+	template<class T>
+	inline void writeElement(std::ostream& out, const T& component)
+	{
+		if constexpr (HasSerializer<T>::value)
+		{
+			writeValue(out, component.belongsToID());
+			writeValue(out, static_cast<std::uint8_t>(component.isActive() ? 1 : 0));
+			component.serialize(out);
+		}
+		else
+		{
+			writeRaw(out, &component, 1);
+		}
+	}
+
+	/// <summary>
+	/// Checks the active flags of components read as raw bytes, a byte other than 0 or 1 is no bool.
+	/// </summary>
+	/// <returns>True if every flag is valid.</returns>
+	template<class T>
+	inline bool hasValidFlags(const T* components, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			unsigned char flag;
+			std::memcpy(&flag, &components[i].activeSelf, sizeof(flag));
+			if (flag > 1)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Reads one component written by writeElement into component.
+	/// </summary>
+	/// <returns>False if the stream ended or failed or holds an invalid active flag.</returns>
+	template<class T>
+	inline bool readElement(std::istream& in, T& component)
+	{
+		if constexpr (HasSerializer<T>::value)
+		{
+			int id;
+			std::uint8_t active;
+			if (!readValue(in, id) || !readValue(in, active))
+			{
+				return false;
+			}
+			component.setBelongsToID(id);
+			component.setActive(active != 0);
+			component.deserialize(in);
+			return !in.fail();
+		}
+		else
+		{
+			return readRaw(in, &component, 1) && hasValidFlags(&component, 1);
+		}
+	}
+
+	/// <summary>
+	/// Writes every element of list. Lists of trivially copyable components without hooks are one write.
+	/// </summary>
+	template<class T, class Allocator>
+	inline void writeElements(std::ostream& out, std::vector<T, Allocator>& list)
+	{
+		if constexpr (HasSerializer<T>::value)
+		{
+			for (const T& component : list)
+			{
+				writeElement(out, component);
+			}
+		}
+		else
+		{
+			writeRaw(out, list.data(), list.size());
+		}
+	}
+
+	/// <summary>
+	/// Replaces the elements of list with count elements written by writeElements.
+	/// </summary>
+	/// <returns>False if the stream ended or failed or holds an invalid active flag.</returns>
+	template<class T, class Allocator>
+	inline bool readElements(std::istream& in, std::vector<T, Allocator>& list, size_t count)
+	{
+		list.clear();
+		for (size_t position = 0; position < count; position += readStep<T>())
+		{
+			size_t length = std::min(readStep<T>(), count - position);
+			list.resize(position + length);
+			if constexpr (HasSerializer<T>::value)
+			{
+				for (size_t i = 0; i < length; i++)
+				{
+					if (!readElement(in, list[position + i]))
+					{
+						return false;
+					}
+				}
+			}
+			else if (!readRaw(in, list.data() + position, length) || !hasValidFlags(list.data() + position, length))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Structure of arrays dense list for PodComponents. Every listed data member of T lives in its own
+	/// contiguous array along with the id and active state of each component, so update loops only
+	/// pull the fields they use into cache. Every data member of T has to be listed, in the order they are
+	/// declared, as one that isn't would be lost whenever a component is written back. T is rejected when
+	/// it is larger than the listed members need, only a member small enough to fit in their padding slips by.
+	/// 
+	/// Opt in by declaring the storage inside the component:
+	/// using Storage = decs::SoAStorage<MyComponent, &MyComponent::a, &MyComponent::b>;
+	/// 
+	/// Elements are accessed through Reference, a copy of the component that writes itself back to
+	/// the arrays when it goes out of scope, so system.getComponentWithID(id).a = value; still works for
+	/// class type fields. Bind the reference first for built in types: auto&& c = system.getComponentWithID(id);
+	/// Every Reference writes all fields back, so of two live References to the same element the one
+	/// destroyed last overwrites the changes of the other. Keep one at a time. Pointer plays the role of T*
+	/// and of the iterator.
+	/// 
+	/// Loops over many elements should use forEachField, System<T>::forEachField for the active range, which
+	/// hands out references into the arrays of the fields it names and copies no element.
+	/// </summary>
+	/// <typeparam name="T">PodComponent to be stored.</typeparam>
+	/// <typeparam name="Members">Pointers to the data members of T to store.</typeparam>
+	template<class T, auto... Members>
+	class SoAStorage
+	{
+		static_assert(sizeof...(Members) > 0, "SoAStorage needs at least one field");
+		static_assert(!std::disjunction<std::is_array<typename MemberType<decltype(Members)>::type>...>::value,
+			"SoAStorage fields can't be built in arrays, use std::array instead");
+		static_assert(sizeof(T) <= listedLayoutSize<PodComponent<T>, typename MemberType<decltype(Members)>::type...>(),
+			"SoAStorage must list every data member of T in the order they are declared");
+
+	public:
+		class Reference;
+		class Pointer;
+
+		typedef T value_type;
+		typedef Reference reference;
+		typedef Pointer pointer;
+		typedef Pointer iterator;
+
+		/// <summary>
+		/// Copy of an element that is written back to the arrays when destroyed.
+		/// </summary>
+		class Reference : public T
+		{
+		public:
+			Reference(SoAStorage& owner, int position);
+			Reference(const Reference&) = delete;
+			~Reference();
+
+			/// <summary>
+			/// Copies values of another element into this one.
+			/// </summary>
+			Reference& operator=(const Reference& other);
+
+			/// <summary>
+			/// Copies values of a component into this element.
+			/// </summary>
+			Reference& operator=(const T& value);
+
+			T* operator->();
+
+		private:
+			SoAStorage* storage;
+			int index;
+		};
+
+		/// <summary>
+		/// Position of an element in the arrays. Can be null, compared and offset like a pointer.
+		/// </summary>
+		class Pointer
+		{
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef Pointer pointer;
+			typedef Reference reference;
+
+			Pointer();
+			Pointer(std::nullptr_t);
+			Pointer(SoAStorage* owner, int position);
+
+			Reference operator*() const;
+			Reference operator->() const;
+			Reference operator[](int n) const;
+			Pointer& operator++();
+			Pointer operator++(int);
+			Pointer& operator--();
+			Pointer operator--(int);
+			Pointer operator+(int n) const;
+			Pointer operator-(int n) const;
+			std::ptrdiff_t operator-(const Pointer& other) const;
+			bool operator==(const Pointer& other) const;
+			bool operator!=(const Pointer& other) const;
+			explicit operator bool() const;
+
+		private:
+			SoAStorage* storage;
+			int index;
+		};
+
+		size_t size() const;
+		size_t capacity() const;
+		bool empty() const;
+		void reserve(size_t u);
+		void resize(size_t u);
+		void clear();
+		void push_back(const T& value);
+		template<class... Args>
+		void emplace_back(Args&&... args);
+		void pop_back();
+
+		Reference operator[](size_t position);
+		Pointer data();
+		Pointer begin();
+		Pointer end();
+
+		/// <summary>
+		/// Returns the contiguous array holding member of every element.
+		/// </summary>
+		/// <typeparam name="Member">Pointer to a data member listed in Members.</typeparam>
+		/// <returns>Pointer to the first element of the array.</returns>
+		template<auto Member>
+		typename MemberType<decltype(Member)>::type* field();
+
+		/// <summary>
+		/// Returns the id of the element at position without loading its fields.
+		/// </summary>
+		int belongsToID(size_t position) const;
+
+		/// <summary>
+		/// Returns whether the element at position is active without loading its fields.
+		/// </summary>
+		bool isActive(size_t position) const;
+
+		/// <summary>
+		/// Moves the element at from over the element at to, one array at a time.
+		/// </summary>
+		void moveElement(size_t from, size_t to);
+
+		/// <summary>
+		/// Swaps the elements at a and b, one array at a time.
+		/// </summary>
+		void swapElements(size_t a, size_t b);
+
+		/// <summary>
+		/// Copies the element at position out of the arrays.
+		/// </summary>
+		void load(size_t position, T& out) const;
+
+		/// <summary>
+		/// Copies value into the arrays at position.
+		/// </summary>
+		void store(size_t position, const T& value);
+
+		/// <summary>
+		/// Calls function on a copy of every element in [begin, end) and writes it back. The arrays are
+		/// passed as restrict pointers so loads and stores of fields function does not touch are removed.
+		/// </summary>
+		template<class Function>
+		void forEachInRange(int begin, int end, Function& function);
+
+		/// <summary>
+		/// Calls function with references into the arrays of Fields for every element in [begin, end).
+		/// No element is loaded or stored and only the arrays of Fields are touched. Name each field once,
+		/// the arrays are passed as restrict pointers.
+		/// </summary>
+		/// <typeparam name="Fields">Pointers to data members listed in Members.</typeparam>
+		template<auto... Fields, class Function>
+		void forEachField(int begin, int end, Function& function);
+
+	private:
+		Vector<int> ids;
+		Vector<unsigned char> active;
+		std::tuple<AlignedVector<typename MemberType<decltype(Members)>::type>...> arrays;
+
+		template<auto Member>
+		static constexpr int fieldIndex();
+
+		template<size_t... I>
+		void load(size_t position, T& out, std::index_sequence<I...>) const;
+
+		template<size_t... I>
+		void store(size_t position, const T& value, std::index_sequence<I...>);
+
+		template<size_t... I>
+		void moveElement(size_t from, size_t to, std::index_sequence<I...>);
+
+		template<size_t... I>
+		void swapElements(size_t a, size_t b, std::index_sequence<I...>);
+
+		template<size_t... I>
+		void push_back(const T& value, std::index_sequence<I...>);
+
+		template<class Function, size_t... I>
+		void forEachInRange(int begin, int end, Function& function, std::index_sequence<I...>);
+
+		template<class Function, class... F>
+		static void forEachInArrays(int begin, int end, Function& function,
+			int* DECS_RESTRICT idArray, unsigned char* DECS_RESTRICT activeArray, F* DECS_RESTRICT... fieldArrays);
+
+		template<class Function, class... F>
+		static void forEachInFieldArrays(int begin, int end, Function& function, F* DECS_RESTRICT... fieldArrays);
+	};
+
+	template<class T, auto... Members>
+	inline SoAStorage<T, Members...>::Reference::Reference(SoAStorage& owner, int position)
+		: storage(&owner), index(position)
+	{
+		static_assert(std::is_base_of<PodComponent<T>, T>::value, "SoAStorage<T> can only store PodComponent<T>");
+		owner.load(position, *this);
+	}
+
+	template<class T, auto... Members>
+	inline SoAStorage<T, Members...>::Reference::~Reference()
+	{
+		if (static_cast<size_t>(index) < storage->size())
+		{
+			storage->store(index, *this);
+		}
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Reference& SoAStorage<T, Members...>::Reference::operator=(const Reference& other)
+	{
+		T::operator=(other);
+		return *this;
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Reference& SoAStorage<T, Members...>::Reference::operator=(const T& value)
+	{
+		T::operator=(value);
+		return *this;
+	}
+
+	template<class T, auto... Members>
+	inline T* SoAStorage<T, Members...>::Reference::operator->()
+	{
+		return this;
+	}
+
+	template<class T, auto... Members>
+	inline SoAStorage<T, Members...>::Pointer::Pointer() : storage(nullptr), index(0) {}
+
+	template<class T, auto... Members>
+	inline SoAStorage<T, Members...>::Pointer::Pointer(std::nullptr_t) : storage(nullptr), index(0) {}
+
+	template<class T, auto... Members>
+	inline SoAStorage<T, Members...>::Pointer::Pointer(SoAStorage* owner, int position) : storage(owner), index(position) {}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Reference SoAStorage<T, Members...>::Pointer::operator*() const
+	{
+		return Reference(*storage, index);
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Reference SoAStorage<T, Members...>::Pointer::operator->() const
+	{
+		return Reference(*storage, index);
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Reference SoAStorage<T, Members...>::Pointer::operator[](int n) const
+	{
+		return Reference(*storage, index + n);
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer& SoAStorage<T, Members...>::Pointer::operator++()
+	{
+		++index;
+		return *this;
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::Pointer::operator++(int)
+	{
+		Pointer previous = *this;
+		++index;
+		return previous;
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer& SoAStorage<T, Members...>::Pointer::operator--()
+	{
+		--index;
+		return *this;
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::Pointer::operator--(int)
+	{
+		Pointer previous = *this;
+		--index;
+		return previous;
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::Pointer::operator+(int n) const
+	{
+		return Pointer(storage, index + n);
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::Pointer::operator-(int n) const
+	{
+		return Pointer(storage, index - n);
+	}
+
+	template<class T, auto... Members>
+	inline std::ptrdiff_t SoAStorage<T, Members...>::Pointer::operator-(const Pointer& other) const
+	{
+		return index - other.index;
+	}
+
+	template<class T, auto... Members>
+	inline bool SoAStorage<T, Members...>::Pointer::operator==(const Pointer& other) const
+	{
+		return storage == other.storage && index == other.index;
+	}
+
+	template<class T, auto... Members>
+	inline bool SoAStorage<T, Members...>::Pointer::operator!=(const Pointer& other) const
+	{
+		return !(*this == other);
+	}
+
+	template<class T, auto... Members>
+	inline SoAStorage<T, Members...>::Pointer::operator bool() const
+	{
+		return storage != nullptr;
+	}
+
+	template<class T, auto... Members>
+	inline size_t SoAStorage<T, Members...>::size() const
+	{
+		return ids.size();
+	}
+
+	template<class T, auto... Members>
+	inline size_t SoAStorage<T, Members...>::capacity() const
+	{
+		return ids.capacity();
+	}
+
+	template<class T, auto... Members>
+	inline bool SoAStorage<T, Members...>::empty() const
+	{
+		return ids.empty();
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::reserve(size_t u)
+	{
+		ids.reserve(u);
+		active.reserve(u);
+		std::apply([u](auto&... array) { (array.reserve(u), ...); }, arrays);
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::resize(size_t u)
+	{
+		if (u < size())
+		{
+			ids.resize(u);
+			active.resize(u);
+			std::apply([u](auto&... array) { (array.resize(u), ...); }, arrays);
+			return;
+		}
+		reserve(u);
+		while (size() < u)
+		{
+			emplace_back();
+		}
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::clear()
+	{
+		ids.clear();
+		active.clear();
+		std::apply([](auto&... array) { (array.clear(), ...); }, arrays);
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::push_back(const T& value)
+	{
+		push_back(value, std::index_sequence_for<decltype(Members)...>());
+	}
+
+	template<class T, auto... Members>
+	template<class... Args>
+	inline void SoAStorage<T, Members...>::emplace_back(Args&&... args)
+	{
+		T value(std::forward<Args>(args)...);
+		push_back(value);
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::pop_back()
+	{
+		ids.pop_back();
+		active.pop_back();
+		std::apply([](auto&... array) { (array.pop_back(), ...); }, arrays);
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Reference SoAStorage<T, Members...>::operator[](size_t position)
+	{
+		return Reference(*this, static_cast<int>(position));
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::data()
+	{
+		return Pointer(this, 0);
+	}
+
+	template<class T, auto... Members>
+	inline int SoAStorage<T, Members...>::belongsToID(size_t position) const
+	{
+		return ids[position];
+	}
+
+	template<class T, auto... Members>
+	inline bool SoAStorage<T, Members...>::isActive(size_t position) const
+	{
+		return active[position] != 0;
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::moveElement(size_t from, size_t to)
+	{
+		moveElement(from, to, std::index_sequence_for<decltype(Members)...>());
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::swapElements(size_t a, size_t b)
+	{
+		swapElements(a, b, std::index_sequence_for<decltype(Members)...>());
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::begin()
+	{
+		return Pointer(this, 0);
+	}
+
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer SoAStorage<T, Members...>::end()
+	{
+		return Pointer(this, static_cast<int>(size()));
+	}
+
+	template<class T, auto... Members>
+	template<auto Member>
+	inline typename MemberType<decltype(Member)>::type* SoAStorage<T, Members...>::field()
+	{
+		constexpr int index = fieldIndex<Member>();
+		static_assert(index >= 0, "Member is not a field of this SoAStorage");
+		return std::get<index>(arrays).data();
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::load(size_t position, T& out) const
+	{
+		load(position, out, std::index_sequence_for<decltype(Members)...>());
+	}
+
+	template<class T, auto... Members>
+	inline void SoAStorage<T, Members...>::store(size_t position, const T& value)
+	{
+		store(position, value, std::index_sequence_for<decltype(Members)...>());
+	}
+
+	template<class T, auto... Members>
+	template<class Function>
+	inline void SoAStorage<T, Members...>::forEachInRange(int begin, int end, Function& function)
+	{
+		forEachInRange(begin, end, function, std::index_sequence_for<decltype(Members)...>());
+	}
+
+	template<class T, auto... Members>
+	template<auto Member>
+	inline constexpr int SoAStorage<T, Members...>::fieldIndex()
+	{
+		constexpr bool matches[] = { std::is_same<std::integral_constant<decltype(Member), Member>,
+			std::integral_constant<decltype(Members), Members>>::value... };
+		for (int i = 0; i < static_cast<int>(sizeof...(Members)); i++)
+		{
+			if (matches[i])
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	template<class T, auto... Members>
+	template<size_t... I>
+	inline void SoAStorage<T, Members...>::load(size_t position, T& out, std::index_sequence<I...>) const
+	{
+		out.setBelongsToID(ids[position]);
+		out.setActive(active[position] != 0);
+		((out.*Members = std::get<I>(arrays)[position]), ...);
+	}
+
+	template<class T, auto... Members>
+	template<size_t... I>
+	inline void SoAStorage<T, Members...>::store(size_t position, const T& value, std::index_sequence<I...>)
+	{
+		ids[position] = value.belongsToID();
+		active[position] = value.isActive();
+		((std::get<I>(arrays)[position] = value.*Members), ...);
+	}
+
+	template<class T, auto... Members>
+	template<size_t... I>
+	inline void SoAStorage<T, Members...>::moveElement(size_t from, size_t to, std::index_sequence<I...>)
+	{
+		ids[to] = ids[from];
+		active[to] = active[from];
+		((std::get<I>(arrays)[to] = std::move(std::get<I>(arrays)[from])), ...);
+	}
+
+	template<class T, auto... Members>
+	template<size_t... I>
+	inline void SoAStorage<T, Members...>::swapElements(size_t a, size_t b, std::index_sequence<I...>)
+	{
+		std::swap(ids[a], ids[b]);
+		std::swap(active[a], active[b]);
+		(std::swap(std::get<I>(arrays)[a], std::get<I>(arrays)[b]), ...);
+	}
+
+	template<class T, auto... Members>
+	template<size_t... I>
+	inline void SoAStorage<T, Members...>::push_back(const T& value, std::index_sequence<I...>)
+	{
+		ids.push_back(value.belongsToID());
+		active.push_back(value.isActive());
+		(std::get<I>(arrays).push_back(value.*Members), ...);
+	}
+
+	template<class T, auto... Members>
+	template<class Function, size_t... I>
+	inline void SoAStorage<T, Members...>::forEachInRange(int begin, int end, Function& function, std::index_sequence<I...>)
+	{
+		forEachInArrays(begin, end, function, ids.data(), active.data(), std::get<I>(arrays).data()...);
+	}
+
+	template<class T, auto... Members>
+	template<class Function, class... F>
+	inline void SoAStorage<T, Members...>::forEachInArrays(int begin, int end, Function& function,
+		int* DECS_RESTRICT idArray, unsigned char* DECS_RESTRICT activeArray, F* DECS_RESTRICT... fieldArrays)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			T element;
+			element.setBelongsToID(idArray[i]);
+			element.setActive(activeArray[i] != 0);
+			((element.*Members = fieldArrays[i]), ...);
+
+			function(element);
+
+			idArray[i] = element.belongsToID();
+			activeArray[i] = element.isActive();
+			((fieldArrays[i] = element.*Members), ...);
+		}
+	}
+
+	template<class T, auto... Members>
+	template<auto... Fields, class Function>
+	inline void SoAStorage<T, Members...>::forEachField(int begin, int end, Function& function)
+	{
+		forEachInFieldArrays(begin, end, function, field<Fields>()...);
+	}
+
+	template<class T, auto... Members>
+	template<class Function, class... F>
+	inline void SoAStorage<T, Members...>::forEachInFieldArrays(int begin, int end, Function& function, F* DECS_RESTRICT... fieldArrays)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			function(fieldArrays[i]...);
+		}
+	}
+
+	/// <summary>
+	/// Calls function on every element of list in the range [begin, end).
+	/// </summary>
+	template<class T, auto... Members, class Function>
+	inline void forEachInRange(SoAStorage<T, Members...>& list, int begin, int end, Function function)
+	{
+		list.forEachInRange(begin, end, function);
+	}
+
+	/// <summary>
+	/// Calls function with references into the arrays of Fields for every element of list in the range [begin, end).
+	/// </summary>
+	template<auto... Fields, class T, auto... Members, class Function>
+	inline void forEachFieldInRange(SoAStorage<T, Members...>& list, int begin, int end, Function function)
+	{
+		list.template forEachField<Fields...>(begin, end, function);
+	}
+
+	/// <summary>
+	/// Returns the id of the element of list at position.
+	/// </summary>
+	template<class T, auto... Members>
+	inline int belongsToIDAt(SoAStorage<T, Members...>& list, int position)
+	{
+		return list.belongsToID(position);
+	}
+
+	/// <summary>
+	/// Returns the number of elements a range of list has to be a multiple of for it to start and end
+	/// on cache lines in every field array.
+	/// </summary>
+	template<class T, auto... Members>
+	constexpr int cacheLineStride(const SoAStorage<T, Members...>&)
+	{
+		// Every stride is a power of two, so the largest is a multiple of all of them.
+		return std::max({ cacheLineStride<typename MemberType<decltype(Members)>::type>()... });
+	}
+
+	/// <summary>
+	/// Returns whether the element of list at position is active.
+	/// </summary>
+	template<class T, auto... Members>
+	inline bool isActiveAt(SoAStorage<T, Members...>& list, int position)
+	{
+		return list.isActive(position);
+	}
+
+	/// <summary>
+	/// Move assigns the element of list at from to the element at to.
+	/// </summary>
+	template<class T, auto... Members>
+	inline void moveElement(SoAStorage<T, Members...>& list, int from, int to)
+	{
+		list.moveElement(from, to);
+	}
+
+	/// <summary>
+	/// Swaps the elements of list at a and b one array at a time.
+	/// </summary>
+	template<class T, auto... Members>
+	inline void swapElements(SoAStorage<T, Members...>& list, int a, int b)
+	{
+		list.swapElements(a, b);
+	}
+
+	/// <summary>
+	/// Returns a pointer to the element of list at position.
+	/// </summary>
+	template<class T, auto... Members>
+	inline typename SoAStorage<T, Members...>::Pointer pointerAt(SoAStorage<T, Members...>& list, int position)
+	{
+		return list.data() + position;
+	}
+
+	/// <summary>
+	/// Returns a copy of the element of list at position. Unlike a Reference it never writes back.
+	/// </summary>
+	template<class T, auto... Members>
+	inline T readAt(SoAStorage<T, Members...>& list, int position)
+	{
+		T value;
+		list.load(position, value);
+		return value;
+	}
+
+	/// <summary>
+	/// Writes every element of list, loading each out of the arrays.
+	/// </summary>
+	template<class T, auto... Members>
+	inline void writeElements(std::ostream& out, SoAStorage<T, Members...>& list)
+	{
+		T component;
+		for (size_t position = 0; position < list.size(); position++)
+		{
+			list.load(position, component);
+			writeElement(out, component);
+		}
+	}
+
+	/// <summary>
+	/// Replaces the elements of list with count elements written by writeElements.
+	/// </summary>
+	/// <returns>False if the stream ended or failed.</returns>
+	template<class T, auto... Members>
+	inline bool readElements(std::istream& in, SoAStorage<T, Members...>& list, size_t count)
+	{
+		list.clear();
+		T component;
+		for (size_t position = 0; position < count; position++)
+		{
+			if (position % readStep<T>() == 0)
+			{
+				list.resize(std::min(position + readStep<T>(), count));
+			}
+			if (!readElement(in, component))
+			{
+				return false;
+			}
+			list.store(position, component);
+		}
+		return true;
+	}
+} // End SoAStorage
+
+namespace decs
+{
+	/// <summary>
+	/// Returns the largest power of two that is not above count, at least 1.
+	/// </summary>
+	constexpr size_t floorPowerOfTwo(size_t count)
+	{
+		size_t power = 1;
+		while (power * 2 <= count)
+		{
+			power *= 2;
+		}
+		return power;
+	}
+
+	/// <summary>
+	/// Returns n where power is 2 to the power of n.
+	/// </summary>
+	constexpr size_t powerOfTwoExponent(size_t power)
+	{
+		size_t exponent = 0;
+		while ((static_cast<size_t>(1) << exponent) < power)
+		{
+			++exponent;
+		}
+		return exponent;
+	}
+
+	/// <summary>
+	/// Dense list built from fixed size chunks. Growing the list allocates another chunk and never moves
+	/// the elements already stored, so pointers returned by getPtrComponentWithID survive inserts.
+	/// Removing a component still moves the last component of the list into the removed slot, and a
+	/// Group moves components when it packs them, so a pointer is valid until the next removal from
+	/// the system, or the next insert if the type is owned by a Group.
+	/// 
+	/// Opt in by declaring the storage inside the component:
+	/// using Storage = decs::ChunkedStorage<MyComponent>;
+	/// 
+	/// Every chunk holds the largest power of two number of elements that fits in ChunkBytes, so finding
+	/// an element is a shift and a mask. Elements are not contiguous across chunks, so there is no data()
+	/// and Group::data can't be used with this storage.
+	/// </summary>
+	/// <typeparam name="T">Component to be stored.</typeparam>
+	/// <typeparam name="ChunkBytes">Size of each chunk in bytes.</typeparam>
+	template<class T, size_t ChunkBytes = 16384>
+	class ChunkedStorage
+	{
+	public:
+		class Iterator;
+
+		typedef T value_type;
+		typedef T& reference;
+		typedef T* pointer;
+		typedef Iterator iterator;
+
+		/// <summary>
+		/// Number of elements in every chunk.
+		/// </summary>
+		static constexpr size_t chunkSize = floorPowerOfTwo(ChunkBytes / sizeof(T));
+
+		/// <summary>
+		/// Position in the list. Plays the role of the iterator.
+		/// </summary>
+		class Iterator
+		{
+		public:
+			Iterator();
+			Iterator(ChunkedStorage* owner, int position);
+
+			T& operator*() const;
+			T* operator->() const;
+			T& operator[](int n) const;
+			Iterator& operator++();
+			Iterator operator++(int);
+			Iterator& operator--();
+			Iterator operator--(int);
+			Iterator operator+(int n) const;
+			Iterator operator-(int n) const;
+			std::ptrdiff_t operator-(const Iterator& other) const;
+			bool operator==(const Iterator& other) const;
+			bool operator!=(const Iterator& other) const;
+
+		private:
+			ChunkedStorage* storage;
+			int index;
+		};
+
+		ChunkedStorage();
+		ChunkedStorage(ChunkedStorage&& other) noexcept;
+		ChunkedStorage(const ChunkedStorage&) = delete;
+		ChunkedStorage& operator=(ChunkedStorage&& other) noexcept;
+		ChunkedStorage& operator=(const ChunkedStorage&) = delete;
+		~ChunkedStorage();
+
+		size_t size() const;
+		size_t capacity() const;
+		bool empty() const;
+		void reserve(size_t u);
+		void resize(size_t u);
+		void clear();
+		void push_back(const T& value);
+		template<class... Args>
+		void emplace_back(Args&&... args);
+		void pop_back();
+
+		T& operator[](size_t position);
+		Iterator begin();
+		Iterator end();
+
+		/// <summary>
+		/// Calls function on every element in [begin, end), walking each chunk as a plain array.
+		/// </summary>
+		template<class Function>
+		void forEachInRange(int begin, int end, Function& function);
+
+	private:
+		static constexpr size_t chunkShift = powerOfTwoExponent(chunkSize);
+		static constexpr size_t chunkMask = chunkSize - 1;
+		static constexpr size_t chunkAlignment = std::max(alignof(T), cacheLineSize);
+
+		Vector<T*> chunks;
+		size_t count;
+
+		/// <summary>
+		/// Returns the address of the slot at position, constructed or not.
+		/// </summary>
+		T* slot(size_t position);
+
+		/// <summary>
+		/// Returns the slot at the end of the list, allocating a chunk if every chunk is full.
+		/// </summary>
+		T* nextSlot();
+
+		/// <summary>
+		/// Destroys every element and frees every chunk.
+		/// </summary>
+		void release();
+	};
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedStorage<T, ChunkBytes>::Iterator::Iterator() : storage(nullptr), index(0) {}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedStorage<T, ChunkBytes>::Iterator::Iterator(ChunkedStorage* owner, int position) : storage(owner), index(position) {}
+
+	template<class T, size_t ChunkBytes>
+	inline T& ChunkedStorage<T, ChunkBytes>::Iterator::operator*() const
+	{
+		return (*storage)[index];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T* ChunkedStorage<T, ChunkBytes>::Iterator::operator->() const
+	{
+		return &(*storage)[index];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T& ChunkedStorage<T, ChunkBytes>::Iterator::operator[](int n) const
+	{
+		return (*storage)[index + n];
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator& ChunkedStorage<T, ChunkBytes>::Iterator::operator++()
+	{
+		++index;
+		return *this;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator ChunkedStorage<T, ChunkBytes>::Iterator::operator++(int)
+	{
+		Iterator previous = *this;
+		++index;
+		return previous;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator& ChunkedStorage<T, ChunkBytes>::Iterator::operator--()
+	{
+		--index;
+		return *this;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator ChunkedStorage<T, ChunkBytes>::Iterator::operator--(int)
+	{
+		Iterator previous = *this;
+		--index;
+		return previous;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator ChunkedStorage<T, ChunkBytes>::Iterator::operator+(int n) const
+	{
+		return Iterator(storage, index + n);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator ChunkedStorage<T, ChunkBytes>::Iterator::operator-(int n) const
+	{
+		return Iterator(storage, index - n);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline std::ptrdiff_t ChunkedStorage<T, ChunkBytes>::Iterator::operator-(const Iterator& other) const
+	{
+		return index - other.index;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline bool ChunkedStorage<T, ChunkBytes>::Iterator::operator==(const Iterator& other) const
+	{
+		return storage == other.storage && index == other.index;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline bool ChunkedStorage<T, ChunkBytes>::Iterator::operator!=(const Iterator& other) const
+	{
+		return !(*this == other);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedStorage<T, ChunkBytes>::ChunkedStorage() : count(0) {}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedStorage<T, ChunkBytes>::ChunkedStorage(ChunkedStorage&& other) noexcept
+		: chunks(std::move(other.chunks)), count(other.count)
+	{
+		other.chunks.clear();
+		other.count = 0;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedStorage<T, ChunkBytes>& ChunkedStorage<T, ChunkBytes>::operator=(ChunkedStorage&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			chunks = std::move(other.chunks);
+			count = other.count;
+			other.chunks.clear();
+			other.count = 0;
+		}
+		return *this;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline ChunkedStorage<T, ChunkBytes>::~ChunkedStorage()
+	{
+		release();
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline size_t ChunkedStorage<T, ChunkBytes>::size() const
+	{
+		return count;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline size_t ChunkedStorage<T, ChunkBytes>::capacity() const
+	{
+		return chunks.size() * chunkSize;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline bool ChunkedStorage<T, ChunkBytes>::empty() const
+	{
+		return count == 0;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedStorage<T, ChunkBytes>::reserve(size_t u)
+	{
+		while (capacity() < u)
+		{
+			void* chunk = Memory::resource()->allocate(sizeof(T) * chunkSize, chunkAlignment);
+			chunks.push_back(static_cast<T*>(chunk));
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedStorage<T, ChunkBytes>::resize(size_t u)
+	{
+		while (count > u)
+		{
+			pop_back();
+		}
+		reserve(u);
+		while (count < u)
+		{
+			emplace_back();
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedStorage<T, ChunkBytes>::clear()
+	{
+		while (count > 0)
+		{
+			pop_back();
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedStorage<T, ChunkBytes>::push_back(const T& value)
+	{
+		::new (static_cast<void*>(nextSlot())) T(value);
+		++count;
+	}
+
+	template<class T, size_t ChunkBytes>
+	template<class... Args>
+	inline void ChunkedStorage<T, ChunkBytes>::emplace_back(Args&&... args)
+	{
+		::new (static_cast<void*>(nextSlot())) T(std::forward<Args>(args)...);
+		++count;
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedStorage<T, ChunkBytes>::pop_back()
+	{
+		--count;
+		slot(count)->~T();
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T& ChunkedStorage<T, ChunkBytes>::operator[](size_t position)
+	{
+		return *slot(position);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator ChunkedStorage<T, ChunkBytes>::begin()
+	{
+		return Iterator(this, 0);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline typename ChunkedStorage<T, ChunkBytes>::Iterator ChunkedStorage<T, ChunkBytes>::end()
+	{
+		return Iterator(this, static_cast<int>(count));
+	}
+
+	template<class T, size_t ChunkBytes>
+	template<class Function>
+	inline void ChunkedStorage<T, ChunkBytes>::forEachInRange(int begin, int end, Function& function)
+	{
+		size_t position = static_cast<size_t>(begin);
+		size_t last = static_cast<size_t>(end);
+		while (position < last)
+		{
+			T* chunk = chunks[position >> chunkShift];
+			size_t first = position & chunkMask;
+			size_t stop = std::min(chunkSize, first + (last - position));
+			for (size_t i = first; i < stop; i++)
+			{
+				function(chunk[i]);
+			}
+			position += stop - first;
+		}
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T* ChunkedStorage<T, ChunkBytes>::slot(size_t position)
+	{
+		return chunks[position >> chunkShift] + (position & chunkMask);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline T* ChunkedStorage<T, ChunkBytes>::nextSlot()
+	{
+		if (count == capacity())
+		{
+			reserve(count + 1);
+		}
+		return slot(count);
+	}
+
+	template<class T, size_t ChunkBytes>
+	inline void ChunkedStorage<T, ChunkBytes>::release()
+	{
+		clear();
+		for (T* chunk : chunks)
+		{
+			Memory::resource()->deallocate(chunk, sizeof(T) * chunkSize, chunkAlignment);
+		}
+		chunks.clear();
+	}
+
+	/// <summary>
+	/// Calls function on every element of list in the range [begin, end).
+	/// </summary>
+	template<class T, size_t ChunkBytes, class Function>
+	inline void forEachInRange(ChunkedStorage<T, ChunkBytes>& list, int begin, int end, Function function)
+	{
+		list.forEachInRange(begin, end, function);
+	}
+
+	/// <summary>
+	/// Calls function with references to Fields of every element of list in the range [begin, end).
+	/// </summary>
+	template<auto... Fields, class T, size_t ChunkBytes, class Function>
+	inline void forEachFieldInRange(ChunkedStorage<T, ChunkBytes>& list, int begin, int end, Function function)
+	{
+		forEachInRange(list, begin, end, [&function](T& component)
+		{
+			function((component.*Fields)...);
+		});
+	}
+
+	/// <summary>
+	/// Returns the id of the element of list at position.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline int belongsToIDAt(ChunkedStorage<T, ChunkBytes>& list, int position)
+	{
+		return list[position].belongsToID();
+	}
+
+	/// <summary>
+	/// Returns the number of elements a range of list has to be a multiple of for it to start and end
+	/// on cache lines.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	constexpr int cacheLineStride(const ChunkedStorage<T, ChunkBytes>&)
+	{
+		// Every chunk starts on a line and both are powers of two, so a chunk either ends on a line
+		// or is shorter than the stride and a line boundary anyway.
+		return std::min(cacheLineStride<T>(), static_cast<int>(ChunkedStorage<T, ChunkBytes>::chunkSize));
+	}
+
+	/// <summary>
+	/// Returns whether the element of list at position is active.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline bool isActiveAt(ChunkedStorage<T, ChunkBytes>& list, int position)
+	{
+		return list[position].isActive();
+	}
+
+	/// <summary>
+	/// Move assigns the element of list at from to the element at to.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline void moveElement(ChunkedStorage<T, ChunkBytes>& list, int from, int to)
+	{
+		list[to] = std::move(list[from]);
+	}
+
+	/// <summary>
+	/// Swaps the elements of list at a and b by moving them.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline void swapElements(ChunkedStorage<T, ChunkBytes>& list, int a, int b)
+	{
+		std::swap(list[a], list[b]);
+	}
+
+	/// <summary>
+	/// Returns a pointer to the element of list at position.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline T* pointerAt(ChunkedStorage<T, ChunkBytes>& list, int position)
+	{
+		return &list[position];
+	}
+
+	/// <summary>
+	/// Returns the element of list at position for reading only.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline const T& readAt(ChunkedStorage<T, ChunkBytes>& list, int position)
+	{
+		return list[position];
+	}
+
+	/// <summary>
+	/// Writes every element of list, one chunk at a time for trivially copyable components without hooks.
+	/// </summary>
+	template<class T, size_t ChunkBytes>
+	inline void writeElements(std::ostream& out, ChunkedStorage<T, ChunkBytes>& list)
+	{
+		constexpr size_t chunkSize = ChunkedStorage<T, ChunkBytes>::chunkSize;
+		for (size_t position = 0; position < list.size(); position += chunkSize)
+		{
+			size_t count = std::min(chunkSize, list.size() - position);
+			if constexpr (HasSerializer<T>::value)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					writeElement(out, list[position + i]);
+				}
+			}
+			else
+			{
+				writeRaw(out, &list[position], count);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Replaces the elements of list with count elements written by writeElements.
+	/// </summary>
+	/// <returns>False if the stream ended or failed or holds an invalid active flag.</returns>
+	template<class T, size_t ChunkBytes>
+	inline bool readElements(std::istream& in, ChunkedStorage<T, ChunkBytes>& list, size_t count)
+	{
+		constexpr size_t chunkSize = ChunkedStorage<T, ChunkBytes>::chunkSize;
+		list.clear();
+		for (size_t position = 0; position < count; position += chunkSize)
+		{
+			size_t length = std::min(chunkSize, count - position);
+			list.resize(position + length);
+			if constexpr (HasSerializer<T>::value)
+			{
+				for (size_t i = 0; i < length; i++)
+				{
+					if (!readElement(in, list[position + i]))
+					{
+						return false;
+					}
+				}
+			}
+			else if (!readRaw(in, &list[position], length) || !hasValidFlags(&list[position], length))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // End ChunkedStorage
+
+namespace decs
+{
+	/// <summary>
+	/// Number of components each entity id has across all systems. SparseSet<T>
+	/// updates it on every insert and remove, so World can find entities left with
+	/// no components without asking every system about every id.
+	/// 
+	/// Ids in the reuse pool are marked free. An id whose count drops to 0 is
+	/// queued as an orphan until World recycles it. Every Registry has its own.
+	/// Inserting or removing components from systems updating in parallel is not
+	/// safe, record those in a CommandBuffer instead.
+	/// </summary>
+	class ComponentCounter
+	{
+	public:
+		/// <summary>
+		/// Count of an id that is in the reuse pool.
+		/// </summary>
+		static constexpr int free_id = -1;
+
+		/// <summary>
+		/// Called when a component is added to id.
+		/// </summary>
+		void added(int id);
+
+		/// <summary>
+		/// Called when a component is removed from id.
+		/// Queues id as an orphan if it has no components left.
+		/// </summary>
+		void removed(int id);
+
+		/// <summary>
+		/// Returns the number of components id has, free_id if it is in the reuse pool.
+		/// </summary>
+		int count(int id);
+
+		/// <summary>
+		/// Marks id as being in the reuse pool.
+		/// </summary>
+		void setFree(int id);
+
+		/// <summary>
+		/// Marks id as handed out if it is still free. Ids given
+		/// components while in the pool are already in use.
+		/// </summary>
+		/// <returns>True if id was free.</returns>
+		bool take(int id);
+
+		/// <summary>
+		/// Ids that dropped to no components since the list was last cleared.
+		/// Can contain ids that have gained components again or appear more than once.
+		/// </summary>
+		Vector<int>& orphans();
+
+		/// <summary>
+		/// Returns the number of components added and removed so far.
+		/// </summary>
+		std::uint64_t changeCount();
+
+		/// <summary>
+		/// Writes every count and the orphans not yet recycled.
+		/// </summary>
+		void write(std::ostream& out) const;
+
+		/// <summary>
+		/// Replaces the counts and orphans with ones written by write.
+		/// </summary>
+		/// <returns>False if the stream ended or failed, or holds a count below free_id or an orphan without a count.</returns>
+		bool read(std::istream& in);
+
+		/// <summary>
+		/// Returns one past the highest id that has a count.
+		/// </summary>
+		int idCount() const;
+
+		/// <summary>
+		/// Checks the counts against the components found per id, ids past the end of tally have none.
+		/// </summary>
+		/// <returns>True if every id has as many components as tally holds for it.</returns>
+		bool matches(const Vector<int>& tally) const;
+
+	private:
+		Vector<int> counts;
+		Vector<int> orphanList;
+		std::uint64_t changes = 0;
+
+		int& slot(int id);
+	};
+
+	inline int& ComponentCounter::slot(int id)
+	{
+		if (static_cast<size_t>(id) >= counts.size())
+		{
+			counts.resize(id + 1, 0);
+		}
+		return counts[id];
+	}
+
+	inline void ComponentCounter::added(int id)
+	{
+		int& componentCount = slot(id);
+		componentCount = componentCount == free_id ? 1 : componentCount + 1;
+		++changes;
+	}
+
+	inline void ComponentCounter::removed(int id)
+	{
+		++changes;
+		if (--counts[id] == 0)
+		{
+			orphanList.push_back(id);
+		}
+	}
+
+	inline int ComponentCounter::count(int id)
+	{
+		if (static_cast<size_t>(id) >= counts.size())
+		{
+			return 0;
+		}
+		return counts[id];
+	}
+
+	inline void ComponentCounter::setFree(int id)
+	{
+		slot(id) = free_id;
+	}
+
+	inline bool ComponentCounter::take(int id)
+	{
+		int& componentCount = slot(id);
+		if (componentCount != free_id)
+		{
+			return false;
+		}
+		componentCount = 0;
+		return true;
+	}
+
+	inline Vector<int>& ComponentCounter::orphans()
+	{
+		return orphanList;
+	}
+
+	inline std::uint64_t ComponentCounter::changeCount()
+	{
+		return changes;
+	}
+
+	inline void ComponentCounter::write(std::ostream& out) const
+	{
+		writeList(out, counts);
+		writeList(out, orphanList);
+		writeValue(out, changes);
+	}
+
+	inline bool ComponentCounter::read(std::istream& in)
+	{
+		if (!readList(in, counts) || !readList(in, orphanList) || !readValue(in, changes))
+		{
+			return false;
+		}
+		for (int componentCount : counts)
+		{
+			if (componentCount < free_id)
+			{
+				return false;
+			}
+		}
+		for (int id : orphanList)
+		{
+			if (id < 0 || static_cast<size_t>(id) >= counts.size())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline int ComponentCounter::idCount() const
+	{
+		return static_cast<int>(counts.size());
+	}
+
+	inline bool ComponentCounter::matches(const Vector<int>& tally) const
+	{
+		for (size_t id = 0; id < std::max(counts.size(), tally.size()); id++)
+		{
+			int componentCount = id < counts.size() ? std::max(counts[id], 0) : 0;
+			if (componentCount != (id < tally.size() ? tally[id] : 0))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+} // End ComponentCounter
+
+namespace decs
+{
+	/// <summary>
+	/// Set of component types, one bit per System<T>::staticSystemID().
+	/// Used to ask SignatureIndex which entities have or lack components.
+	/// </summary>
+	class Signature
+	{
+	public:
+		/// <summary>
+		/// Returns a signature with the bits of every component type set.
+		/// </summary>
+		template<class... Components>
+		static Signature of();
+
+		void set(int systemID);
+
+		void reset(int systemID);
+
+		bool test(int systemID) const;
+
+		/// <summary>
+		/// Number of 64 bit words used. Words past this are 0.
+		/// </summary>
+		int wordCount() const;
+
+		std::uint64_t word(int index) const;
+
+	private:
+		std::vector<std::uint64_t> words;
+	};
+
+	inline void Signature::set(int systemID)
+	{
+		size_t index = systemID / 64;
+		if (index >= words.size())
+		{
+			words.resize(index + 1, 0);
+		}
+		words[index] |= std::uint64_t(1) << (systemID % 64);
+	}
+
+	inline void Signature::reset(int systemID)
+	{
+		size_t index = systemID / 64;
+		if (index < words.size())
+		{
+			words[index] &= ~(std::uint64_t(1) << (systemID % 64));
+		}
+	}
+
+	inline bool Signature::test(int systemID) const
+	{
+		return (word(systemID / 64) >> (systemID % 64)) & 1;
+	}
+
+	inline int Signature::wordCount() const
+	{
+		return static_cast<int>(words.size());
+	}
+
+	inline std::uint64_t Signature::word(int index) const
+	{
+		if (index >= static_cast<int>(words.size()))
+		{
+			return 0;
+		}
+		return words[index];
+	}
+} // End Signature
+
+namespace decs
+{
+	/// <summary>
+	/// Returns the index of the lowest set bit of word. Word must not be 0.
+	/// </summary>
+	inline int lowestBit(std::uint64_t word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(word);
+#else
+		int index = 0;
+		while ((word & 1) == 0)
+		{
+			word >>= 1;
+			++index;
+		}
+		return index;
+#endif
+	}
+
+	/// <summary>
+	/// Signature of every entity id, stored back to back as 64 bit words so
+	/// checking several component types is a couple of ands instead of a
+	/// virtual hasComponentWithID call per system. SparseSet<T> sets the bit of its
+	/// system when an id gets its first component and clears it when the last one goes.
+	/// 
+	/// Every Registry has its own. The same rules as ComponentCounter apply to
+	/// systems updating in parallel.
+	/// </summary>
+	class SignatureIndex
+	{
+	public:
+		void set(int id, int systemID);
+
+		void reset(int id, int systemID);
+
+		/// <summary>
+		/// Makes room for ids below idCount and system ids below systemCount up front,
+		/// so setting the bits of many ids doesn't grow the index one id at a time.
+		/// </summary>
+		void reserve(int idCount, int systemCount);
+
+		/// <summary>
+		/// Returns true if id has every component type in include and none in exclude.
+		/// </summary>
+		bool matches(int id, const Signature& include, const Signature& exclude);
+
+		/// <summary>
+		/// Fills ids with every id that has all component types in include and
+		/// none in exclude, in ascending order.
+		/// </summary>
+		void query(const Signature& include, const Signature& exclude, std::vector<int>& ids);
+
+		/// <summary>
+		/// Returns one past the highest id that has had a component.
+		/// </summary>
+		int idCount();
+
+		/// <summary>
+		/// Calls function(systemID) for every component type id has, lowest system id first.
+		/// Function can reset bits of id, each word is read before its types are visited.
+		/// </summary>
+		template<class Function>
+		void forEachType(int id, Function function);
+
+	private:
+		Vector<std::uint64_t> bits;
+		int wordsPerID = 1;
+		int idCapacity = 0;
+
+		/// <summary>
+		/// Makes room for id and systemID. Adding a word moves every signature
+		/// but only happens when more than a multiple of 64 systems exist.
+		/// </summary>
+		void grow(int id, int systemID);
+	};
+
+	inline void SignatureIndex::grow(int id, int systemID)
+	{
+		int words = std::max(wordsPerID, systemID / 64 + 1);
+		if (words != wordsPerID)
+		{
+			Vector<std::uint64_t> widened(static_cast<size_t>(idCapacity) * words, 0);
+			for (int i = 0; i < idCapacity; i++)
+			{
+				std::copy(bits.begin() + i * wordsPerID, bits.begin() + (i + 1) * wordsPerID, widened.begin() + i * words);
+			}
+			bits.swap(widened);
+			wordsPerID = words;
+		}
+		if (id >= idCapacity)
+		{
+			idCapacity = id + 1;
+			bits.resize(static_cast<size_t>(idCapacity) * wordsPerID, 0);
+		}
+	}
+
+	inline void SignatureIndex::set(int id, int systemID)
+	{
+		if (id >= idCapacity || systemID >= wordsPerID * 64)
+		{
+			grow(id, systemID);
+		}
+		bits[static_cast<size_t>(id) * wordsPerID + systemID / 64] |= std::uint64_t(1) << (systemID % 64);
+	}
+
+	inline void SignatureIndex::reserve(int idCount, int systemCount)
+	{
+		if (idCount > idCapacity || systemCount > wordsPerID * 64)
+		{
+			grow(std::max(idCount, 1) - 1, std::max(systemCount, 1) - 1);
+		}
+	}
+
+	inline void SignatureIndex::reset(int id, int systemID)
+	{
+		if (id >= idCapacity || systemID >= wordsPerID * 64)
+		{
+			return;
+		}
+		bits[static_cast<size_t>(id) * wordsPerID + systemID / 64] &= ~(std::uint64_t(1) << (systemID % 64));
+	}
+
+	inline bool SignatureIndex::matches(int id, const Signature& include, const Signature& exclude)
+	{
+		if (id < 0 || id >= idCapacity)
+		{
+			return include.wordCount() == 0;
+		}
+		const std::uint64_t* signature = bits.data() + static_cast<size_t>(id) * wordsPerID;
+		int words = std::max(wordsPerID, include.wordCount());
+		for (int i = 0; i < words; i++)
+		{
+			std::uint64_t has = i < wordsPerID ? signature[i] : 0;
+			std::uint64_t required = include.word(i);
+			if ((has & required) != required || (has & exclude.word(i)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	inline void SignatureIndex::query(const Signature& include, const Signature& exclude, std::vector<int>& ids)
+	{
+		ids.clear();
+		// No id can have a component type that hasn't got a word yet.
+		for (int i = wordsPerID; i < include.wordCount(); i++)
+		{
+			if (include.word(i) != 0)
+			{
+				return;
+			}
+		}
+		if (idCapacity == 0)
+		{
+			return;
+		}
+
+		// Every id is written and the count only moves on a match, so the scan has no
+		// branches on the signatures and the compiler can keep it in registers.
+		ids.resize(idCapacity);
+		int* DECS_RESTRICT matched = ids.data();
+		const std::uint64_t* DECS_RESTRICT signatures = bits.data();
+		int found = 0;
+
+		if (wordsPerID == 1)
+		{
+			std::uint64_t required = include.word(0);
+			std::uint64_t excluded = exclude.word(0);
+			int id = 0;
+#if defined(DECS_SSE2)
+			// Two signatures per register. SSE2 only compares 32 bit lanes, so a signature matches
+			// when both halves of what it is missing compare equal to zero.
+			const __m128i requiredBits = _mm_set1_epi64x(static_cast<long long>(required));
+			const __m128i excludedBits = _mm_set1_epi64x(static_cast<long long>(excluded));
+			const __m128i zero = _mm_setzero_si128();
+			for (; id + 2 <= idCapacity; id += 2)
+			{
+				__m128i has = _mm_loadu_si128(reinterpret_cast<const __m128i*>(signatures + id));
+				__m128i missing = _mm_or_si128(_mm_andnot_si128(has, requiredBits), _mm_and_si128(has, excludedBits));
+				__m128i halves = _mm_cmpeq_epi32(missing, zero);
+				halves = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+				int matches = _mm_movemask_pd(_mm_castsi128_pd(halves));
+				matched[found] = id;
+				found += matches & 1;
+				matched[found] = id + 1;
+				found += matches >> 1;
+			}
+#endif
+			for (; id < idCapacity; id++)
+			{
+				std::uint64_t has = signatures[id];
+				matched[found] = id;
+				found += ((has & required) == required) & ((has & excluded) == 0);
+			}
+		}
+		else
+		{
+			for (int id = 0; id < idCapacity; id++)
+			{
+				const std::uint64_t* signature = signatures + static_cast<size_t>(id) * wordsPerID;
+				std::uint64_t missing = 0;
+				for (int i = 0; i < wordsPerID; i++)
+				{
+					missing |= (signature[i] & include.word(i)) ^ include.word(i);
+					missing |= signature[i] & exclude.word(i);
+				}
+				matched[found] = id;
+				found += missing == 0;
+			}
+		}
+		ids.resize(found);
+	}
+
+	inline int SignatureIndex::idCount()
+	{
+		return idCapacity;
+	}
+
+	template<class Function>
+	inline void SignatureIndex::forEachType(int id, Function function)
+	{
+		if (id < 0 || id >= idCapacity)
+		{
+			return;
+		}
+		for (int i = 0; i < wordsPerID; i++)
+		{
+			std::uint64_t word = bits[static_cast<size_t>(id) * wordsPerID + i];
+			while (word != 0)
+			{
+				function(i * 64 + lowestBit(word));
+				// Clear the lowest set bit.
+				word &= word - 1;
+			}
+		}
+	}
+
+} // End SignatureIndex
+
+namespace decs
+{
+	/// <summary>
+	/// Callbacks a Group installs in the SparseSet of every component type it owns.
+	/// The group state kept by a Registry derives from this and is passed back to each callback.
+	/// </summary>
+	struct GroupHooks
+	{
+		/// <summary>
+		/// Called after a component of id was added or removed while id still has one.
+		/// </summary>
+		void (*changed)(GroupHooks& group, int id);
+
+		/// <summary>
+		/// Called before the component of id at position is removed.
+		/// Returns the position the component was moved to.
+		/// </summary>
+		int (*removing)(GroupHooks& group, int id, int position);
+
+		/// <summary>
+		/// Called when the list is cleared.
+		/// </summary>
+		void (*cleared)(GroupHooks& group);
+
+		/// <summary>
+		/// Called after Registry::restore replaced every list, which can leave the group unpacked.
+		/// </summary>
+		void (*restored)(GroupHooks& group);
+	};
+} // End GroupHooks
+
+namespace decs
+{
+	/// <summary>
+	/// Set of ids with O(1) insert, erase and contains. Members are kept packed in insertion order,
+	/// apart from erase moving the last member into the hole, so iterating only touches members.
+	/// </summary>
+	class IDSet
+	{
+	public:
+		/// <summary>
+		/// Adds id. Does nothing if id is negative or already a member.
+		/// </summary>
+		/// <returns>True if id was added.</returns>
+		bool insert(int id);
+
+		/// <summary>
+		/// Removes id. Does nothing if id isn't a member.
+		/// </summary>
+		/// <returns>True if id was removed.</returns>
+		bool erase(int id);
+
+		bool contains(int id) const;
+
+		int size() const;
+
+		bool empty() const;
+
+		/// <summary>
+		/// Returns the members, size() of them.
+		/// </summary>
+		const int* data() const;
+
+		const int* begin() const;
+		const int* end() const;
+
+		/// <summary>
+		/// Removes every member. O(size()) and keeps the memory for the next batch.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Calls function with every member then removes them all. Ids inserted by function are
+		/// visited as well. Function must not erase members.
+		/// </summary>
+		/// <param name="function">Called with each id.</param>
+		template<class Function>
+		void drain(Function function);
+
+	private:
+		Vector<int> members;
+
+		// Position of every id in members, -1 if it isn't a member.
+		Vector<int> positions;
+	};
+
+	inline bool IDSet::insert(int id)
+	{
+		if (id < 0 || contains(id))
+		{
+			return false;
+		}
+		if (static_cast<size_t>(id) >= positions.size())
+		{
+			positions.resize(id + 1, -1);
+		}
+		positions[id] = static_cast<int>(members.size());
+		members.push_back(id);
+		return true;
+	}
+
+	inline bool IDSet::erase(int id)
+	{
+		if (!contains(id))
+		{
+			return false;
+		}
+		int position = positions[id];
+		int last = members.back();
+		members[position] = last;
+		positions[last] = position;
+		members.pop_back();
+		positions[id] = -1;
+		return true;
+	}
+
+	inline bool IDSet::contains(int id) const
+	{
+		return id >= 0 && static_cast<size_t>(id) < positions.size() && positions[id] != -1;
+	}
+
+	inline int IDSet::size() const
+	{
+		return static_cast<int>(members.size());
+	}
+
+	inline bool IDSet::empty() const
+	{
+		return members.empty();
+	}
+
+	inline const int* IDSet::data() const
+	{
+		return members.data();
+	}
+
+	inline const int* IDSet::begin() const
+	{
+		return members.data();
+	}
+
+	inline const int* IDSet::end() const
+	{
+		return members.data() + members.size();
+	}
+
+	inline void IDSet::clear()
+	{
+		for (int id : members)
+		{
+			positions[id] = -1;
+		}
+		members.clear();
+	}
+
+	template<class Function>
+	inline void IDSet::drain(Function function)
+	{
+		// Indexed so members inserted by function, which can grow the list, are reached too.
+		for (size_t i = 0; i < members.size(); i++)
+		{
+			function(members[i]);
+		}
+		clear();
+	}
+
+	/// <summary>
+	/// Ids that had a component of one type added, removed or replaced since each list was last
+	/// drained or cleared. An id is in a list once however often it happened, and can be in more
+	/// than one list, for example added and removed in the same frame. Check the current state with
+	/// has when the order matters.
+	/// </summary>
+	struct ComponentEvents
+	{
+		IDSet added;
+		IDSet removed;
+		IDSet replaced;
+	};
+} // End IDSet
+
+namespace decs
+{
+	/// <summary>
+	///	SparseSet is a modified class based on Sam Griffiths class 
+	/// template of a sparse set of integers. The original
+	/// can be found here: https://gist.github.com/sjgriffiths/06732c6076b9db8a7cf4dfe3a7aed43a
+	/// 
+	/// Class and Struct Components created must inherit from the Component class or PodComponent<T> to use this.
+	/// Initialise and update are called through T directly so they are never dispatched through the vtable.
+	/// 
+	/// The dense list is a Vector<T> unless T selects another container with a nested Storage alias,
+	/// see StorageOf, SoAStorage and ChunkedStorage.
+	/// 
+	/// Every Registry owns one SparseSet per component type, reach it through System<T>.
+	/// 
+	/// The dense list is partitioned into active components, inactive components and the pool, in that
+	/// order, so update only walks the active range. Change whether a component is active through
+	/// setActiveWithID so it is moved across the boundary, which can change the index order of
+	/// components sharing an id.
+	/// </summary>
+	/// <typeparam name="T">User defined class/struct that inherits from decs::Component or decs::PodComponent<T>.</typeparam>
+	template <class T>
+	class SparseSet
+	{
+		static_assert(std::is_base_of<ComponentBase, T>::value, "class<T>/struct<T> Must inherit from Component or PodComponent<T>");
+		static_assert(std::is_convertible<T*, Component*>::value || std::is_base_of<PodComponent<T>, T>::value,
+			"class<T>/struct<T> Must inherit from PodComponent<T> with itself as the template argument");
+		static_assert(std::is_convertible<T*, Component*>::value || !std::is_polymorphic<T>::value,
+			"PodComponent<T> must not declare virtual functions, inherit from Component instead");
+
+	public:
+		typedef typename StorageOf<T>::type storage_type;
+		typedef typename storage_type::reference reference;
+		typedef typename storage_type::pointer pointer;
+		typedef typename storage_type::iterator iterator;
+
+		// What read returns, const T& or a copy of T for SoAStorage.
+		typedef decltype(readAt(std::declval<storage_type&>(), 0)) read_type;
+
+	private:
+		int size_dense_vector = 0;
+		int size_active_range = 0;
+		int capacity_sparse_vector = 0;
+
+		// Group that keeps its entities packed at the front of this list or nullptr.
+		GroupHooks* owningGroup = nullptr;
+
+		// Bookkeeping of the Registry that owns this set.
+		ComponentCounter* counter;
+		SignatureIndex* signatures;
+		const std::uint32_t* changeTick;
+
+		// Tick each component in use last changed in, parallel to the dense list. Empty unless tracking.
+		Vector<std::uint32_t> changeTicks;
+		bool trackChanges = false;
+
+		// Ids whose components were added, removed or replaced, only recorded while observing.
+		ComponentEvents events;
+		bool observing = false;
+
+		// Set read by stageSnapshot, kept apart until Registry::restore has checked the whole snapshot.
+		struct StagedSnapshot
+		{
+			int usedSize = 0;
+			int activeSize = 0;
+			int sparseCapacity = 0;
+			storage_type dense;
+			SparseIndex sparse;
+			bool tracked = false;
+			Vector<std::uint32_t> changeTicks;
+		};
+		std::unique_ptr<StagedSnapshot> staged;
+
+		template<class... Components>
+		friend class View;
+
+		template<class... Owned>
+		friend class GroupState;
+
+		/// <summary>
+		/// Swaps the components at positions a and b and updates the sparse index.
+		/// </summary>
+		void swapPositions(int a, int b);
+
+		/// <summary>
+		/// Move assigns the component at from to to and updates the sparse index.
+		/// </summary>
+		void movePosition(int from, int to);
+
+		/// <summary>
+		/// Stamps the component just added to the end of the list and moves it into the active range if it is active.
+		/// </summary>
+		void placeInserted();
+
+	protected:
+		storage_type dense;
+		SparseIndex sparse;
+
+		/// <summary>
+		/// Method to perform a default insert of a newly constructed component.
+		/// </summary>
+		/// <param name="id">ID to tag component with.</param>
+		void defaultInsert(int id);
+
+		/// <summary>
+		/// Method to perform a pooled insert.
+		/// </summary>
+		/// <param name="id">ID to tag component with.</param>
+		void pooledInsert(int id);
+
+		/// <summary>
+		/// Remove algorithm that handles organising dense list for pooling and destrtuction.
+		/// Will reorder components if a component is moved closer to the beginning of dense list.
+		/// O(1) moves of components. The sparse index update is O(1) for ids with one component and
+		/// O(log k + k) for ids with k components, see SparseIndex.
+		/// </summary>
+		/// <param name="id">ID of component to perform removal/deletion on.</param>
+		/// <param name="index">Index position of component to perform removal/deletion on.</param>
+		void rem(int id, int index = 0);
+
+		/// <summary>
+		/// Updates the ComponentCounter and SignatureIndex of the Registry after a component of id is added.
+		/// </summary>
+		void componentAdded(int id);
+
+		/// <summary>
+		/// Updates the ComponentCounter and SignatureIndex of the Registry after a component of id is removed.
+		/// </summary>
+		void componentRemoved(int id);
+
+	public:
+		/// <param name="counter">Component counts of the owning Registry.</param>
+		/// <param name="signatures">Signatures of the owning Registry.</param>
+		/// <param name="changeTick">Change tick of the owning Registry.</param>
+		SparseSet(ComponentCounter& counter, SignatureIndex& signatures, const std::uint32_t& changeTick);
+		~SparseSet();
+
+		SparseSet(const SparseSet&) = delete;
+		SparseSet& operator=(const SparseSet&) = delete;
+
+
+		/// <summary>
+		/// Returns begin iterator of dense list.
+		/// </summary>
+		/// <returns>Returns begin iterator of dense list.</returns>
+		iterator begin();
+
+		/// <summary>
+		/// Retruns last element iterator of dense list.
+		/// </summary>
+		/// <returns>Retruns last element iterator of dense list.</returns>
+		iterator back();
+
+		/// <summary>
+		/// Iterator end of dense list.
+		/// </summary>
+		/// <returns>End iterator of dense list.</returns>
+		iterator end();
+
+		/// <summary>
+		/// Returns size of used components in dense list.
+		/// </summary>
+		/// <returns>Returns size of used components in dense list.</returns>
+		int size();
+
+		/// <summary>
+		/// Returns the amount of IDs in use. Highest id that can be used would be numberOfIDs - 1.
+		/// </summary>
+		/// <returns>Returns the amount of IDs in use.</returns>
+		int numberOfIDs();
+
+		/// <summary>
+		/// Returns size of dense list both active and inactive.
+		/// </summary>
+		/// <returns>Returns size of dense list both active and inactive.</returns>
+		int denseListSize();
+
+		/// <summary>
+		/// Cheks if dense list is currently empty.
+		/// </summary>
+		/// <returns>True if dense list contains no active objects, otherwise returns false if contains objects.</returns>
+		bool empty();
+
+		/// <summary>
+		/// Clears dense list, sparse list and resizes everything back to 0.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Drops the dense list and the sparse list whole instead of removing each component, and
+		/// discards pending events. The counter and the signatures are left alone, so this is only
+		/// for Registry::reset, which replaces them as well. No per component work when T is
+		/// trivially destructible.
+		/// </summary>
+		void reset();
+
+		/// <summary>
+		/// Calls reser on sparse list. Effectively tells the array the highest id that will be used/is in use.
+		/// </summary>
+		/// <param name="u"></param>
+		void reserveIDCapacity(int u);
+
+		/// <summary>
+		/// Calls reserve on dense list.
+		/// </summary>
+		/// <param name="u">Number of components size to reserve.</param>
+		void reserveComponentCapacity(int u);
+
+		/// <summary>
+		/// Checks if component with id exists. Returs false if is doesn't otherwise it returns true.
+		/// </summary>
+		/// <param name="id">ID of component to check if it exists.</param>
+		/// <returns>True if component has ID, false if not found.</returns>
+		bool has(const int id);
+
+		/// <summary>
+		/// Inserts component with ID to dense list. If there is a pooled object this will be initialised with the
+		/// values instead of constructing a new one.
+		/// </summary>
+		/// <param name="id">ID to tag component with.</param>
+		void insert(const int id);
+
+		/// <summary>
+		/// Inserts a component for every id. The sparse and dense lists are grown once for the whole
+		/// batch and pooled components are used first. Negative ids are skipped.
+		/// </summary>
+		/// <param name="ids">IDs to tag components with.</param>
+		/// <param name="count">Number of ids.</param>
+		void insertRange(const int* ids, int count);
+
+		/// <summary>
+		/// Removes all objects not used in the dense list effectively making dense.size() = dense_vector_size.
+		/// </summary>
+		void removePooledObjects();
+
+		/// <summary>
+		/// For adding another component to self. Only use if you are sure there's another component already attached
+		/// as no checks are performed when using this method.
+		/// </summary>
+		/// <param name="id">ID to tag component with.</param>
+		void insertAnotherToSelf(int id);
+
+		/// <summary>
+		/// Returns pointer to first component found with id. Returns nullptr if not found. If dense list resizes after
+		/// lookup pointer will become invalidated, unless T uses ChunkedStorage.
+		/// </summary>
+		/// <param name="id">ID of component to be found.</param>
+		/// <returns>Pointer to component.</returns>
+		pointer ptrGet(const int id);
+
+		/// <summary>
+		/// Returns pointer to component in dense list at given index relative to id.
+		/// Returns nullptr if not found. If dense list is resized after lookup pointer will be invalidated,
+		/// unless T uses ChunkedStorage.
+		/// </summary>
+		/// <param name="id">ID of component to return.</param>
+		/// <param name="index">Index of component relative to id.</param>
+		/// <returns>Pointer to component.</returns>
+		pointer ptrGetAtIndex(const int id, const int index);
+
+		/// <summary>
+		/// Retruns reference to first found component with given id in the dense list.
+		/// Results in undefined behaviour if component doesn't exist. Use with caution.
+		/// For SoAStorage see the caveats of System<T>::getComponentWithID.
+		/// </summary>
+		/// <param name="id">ID of component to be returned.</param>
+		/// <returns>Reference to component in dense list</returns>
+		reference get(const int id);
+
+		/// <summary>
+		/// Returns reference to component with id at index position. Results in undefined behaviour if component doesn't
+		/// exists. Use with caution.
+		/// </summary>
+		/// <param name="id">ID of component to be returned.</param>
+		/// <param name="index">Index of component relative to id to be returned.</param>
+		/// <returns>Reference to Component in dense list.</returns>
+		reference getAtIndex(const int id, const int index);
+
+		/// <summary>
+		/// Returns the first component with id for reading. Unlike get it doesn't stamp a change tick, and for
+		/// SoAStorage it returns a copy instead of a Reference that writes back on destruction, so it writes
+		/// nothing and threads can call it at the same time. Results in undefined behaviour if component doesn't exist.
+		/// </summary>
+		/// <param name="id">ID of component to be read.</param>
+		/// <returns>Const reference to the component, or a copy of it for SoAStorage.</returns>
+		read_type read(const int id);
+
+		/// <summary>
+		/// Returns the component with id at index position for reading, see read. Results in undefined
+		/// behaviour if component doesn't exist.
+		/// </summary>
+		/// <param name="id">ID of component to be read.</param>
+		/// <param name="index">Index of component relative to id to be read.</param>
+		/// <returns>Const reference to the component, or a copy of it for SoAStorage.</returns>
+		read_type readAtIndex(const int id, const int index);
+
+		/// <summary>
+		/// Returns reference to the dense list of components.
+		/// </summary>
+		/// <returns>Dense list of components</returns>
+		storage_type& getDenseList();
+
+		/// <summary>
+		/// Emplaces component to end of dense list with given id.
+		/// </summary>
+		/// <param name="id">ID of component to be emplaced</param>
+		/// <param name="emplaced">Component to have it's values emplaced.</param>
+		void emplace(const int id, T&& emplaced);
+
+		/// <summary>
+		/// Inserts a copy of components values to the end of dense list with given id.
+		/// </summary>
+		/// <param name="id">ID of component that notifies sparse.</param>
+		/// <param name="copy">Component to have it's values copied.</param>
+		void insertCopy(const int id, T& copy);
+
+		/// <summary>
+		/// Destroys first component found with given id that is closest to the begininng of dense list.
+		/// </summary>
+		/// <param name="id">ID tag of component to be destroyed.</param>
+		/// <returns>True if component is destroyed, false if nothing is destroyed.</returns>
+		bool eraseWithID(const int id);
+
+		/// <summary>
+		/// Destroys all component with a given id.
+		/// </summary>
+		/// <param name="id">ID of components to be destroyed.</param>
+		/// <returns>True if components are destroyed, false if nothing is destroyed.</returns>
+		bool eraseAllWithID(const int id);
+
+		/// <summary>
+		/// Destroys component with id tag at the given index. If component can't be found this
+		/// does nothing.
+		/// </summary>
+		/// <param name="id"></param>
+		/// <param name="index"></param>
+		/// <returns></returns>
+		bool eraseWithIDAtIndex(const int id, int index);
+
+		/// <summary>
+		/// Removes first component found closest to the beginning of the dense list. Removed component
+		/// is placed into a pool.
+		/// </summary>
+		/// <param name="id">ID tag of component to be removed.</param>
+		/// <returns>True if component removed, false if nothing is removed.</returns>
+		bool removeWithID(const int id);
+
+		/// <summary>
+		/// Removes all components with given id. Removed components are moved to a pool.
+		/// </summary>
+		/// <param name="id">ID tag of components you want removed.</param>
+		/// <returns>True if all components removed, false if none are removed.</returns>
+		bool removeAllWithID(const int id);
+
+		/// <summary>
+		/// Removes all components of every id. Removed components are moved to a pool.
+		/// </summary>
+		/// <param name="ids">ID tags of components you want removed.</param>
+		/// <param name="count">Number of ids.</param>
+		/// <returns>Number of components removed.</returns>
+		int removeAllWithIDs(const int* ids, int count);
+
+		/// <summary>
+		/// Destroys all components of every id. The dense list is shrunk once after all are removed.
+		/// </summary>
+		/// <param name="ids">ID tags of components you want destroyed.</param>
+		/// <param name="count">Number of ids.</param>
+		/// <returns>Number of components destroyed.</returns>
+		int eraseAllWithIDs(const int* ids, int count);
+
+		/// <summary>
+		/// Removes all components with given id at index based on position closest
+		/// to dense list begin. Removed components are moved to a pool.
+		/// If index isn't found this will return false.
+		/// </summary>
+		/// <param name="id">ID tag of component to be removed.</param>
+		/// <param name="index">Index of component to be removed.</param>
+		/// <returns>True if component removed, false if none are removed.</returns>
+		bool removeWithIDAtIndex(const int id, const int index);
+
+		/// <summary>
+		/// Returns the number of components that share the given id.
+		/// </summary>
+		/// <param name="id">ID of components you want to check.</param>
+		/// <returns>Number of components with given id.</returns>
+		int numberOfComponentsWithID(const int id);
+
+		/// <summary>
+		/// Returns the number of components in use by the dense list, active or not.
+		/// </summary>
+		/// <returns>Number of components in use by the dense list.</returns>
+		int getNumberOfActiveComponents();
+
+		/// <summary>
+		/// Returns the number of active components. They are the first activeRange() components of the dense list.
+		/// </summary>
+		/// <returns>Number of active components.</returns>
+		int activeRange();
+
+		/// <summary>
+		/// Sets whether the first component with id is active and moves it into or out of the active range. O(1).
+		/// </summary>
+		/// <param name="id">ID tag of the component.</param>
+		/// <param name="active">Whether the component should update.</param>
+		/// <returns>True if the component exists, false otherwise.</returns>
+		bool setActiveWithID(const int id, bool active);
+
+		/// <summary>
+		/// Sets whether the component with id at index is active and moves it into or out of the active range. O(1).
+		/// </summary>
+		/// <param name="id">ID tag of the component.</param>
+		/// <param name="index">Index of component relative to id.</param>
+		/// <param name="active">Whether the component should update.</param>
+		/// <returns>True if the component exists, false otherwise.</returns>
+		bool setActiveWithIDAtIndex(const int id, const int index, bool active);
+
+		/// <summary>
+		/// Sets whether the component at position in the dense list is active and moves it to the
+		/// boundary of the active range if that changes.
+		/// </summary>
+		/// <param name="position">Dense list position of a component in use.</param>
+		/// <param name="active">Whether the component should update.</param>
+		void setActiveAt(int position, bool active);
+
+		/// <summary>
+		/// Runs update on every active component in dense list.
+		/// </summary>
+		void runUpdate();
+
+		/// <summary>
+		/// Runs update on every component in [begin, end) of the active range. The range is
+		/// clipped to activeRange() so the loop itself needs no per component check.
+		/// Non overlapping ranges can be updated from different threads as long as
+		/// component updates make no structural changes to this set.
+		/// </summary>
+		/// <param name="begin">First dense list position to update.</param>
+		/// <param name="end">One past the last dense list position to update.</param>
+		void runUpdate(int begin, int end);
+
+		/// <summary>
+		/// replaces component values with id that is closest to the start of the dense list.
+		/// </summary>
+		/// <param name="id">ID tag of the component</param>
+		/// <param name="copy">Component values you want copied</param>
+		void replace(const int id, T& copy);
+
+		/// <summary>
+		/// Replace a component with anothers value. If there is no component this does nothing.
+		/// </summary>
+		/// <param name="id">ID tag of component</param>
+		/// <param name="componentPosition">whether you want the 1st, 2nd... component</param>
+		/// <param name="copy">Component values you want copied</param>
+		void replace(const int id, int componentPosition, T& copy);
+
+		/// <summary>
+		/// Turns keeping the tick each component last changed in on or off. Off by default. Turning it on
+		/// stamps every component in use with the current tick. While on, adding a component, get, ptrGet,
+		/// replace and runUpdate stamp the components they hand out or change. Views, groups and the
+		/// dense list don't, use markChangedAt for changes made through them. read and readAtIndex never stamp.
+		/// </summary>
+		/// <param name="enabled">Whether to track changes.</param>
+		void setChangeTracking(bool enabled);
+
+		/// <summary>
+		/// Returns true if the tick of every change is kept.
+		/// </summary>
+		bool isTrackingChanges();
+
+		/// <summary>
+		/// Returns the tick the component at position last changed in. Only valid while tracking changes.
+		/// </summary>
+		/// <param name="position">Dense list position of a component in use.</param>
+		std::uint32_t changeTickAt(int position);
+
+		/// <summary>
+		/// Stamps the component at position with the current tick. Does nothing unless tracking changes.
+		/// </summary>
+		/// <param name="position">Dense list position of a component in use.</param>
+		void markChangedAt(int position);
+
+		/// <summary>
+		/// Calls function with every component in use that changed after tick, in dense list order.
+		/// The ticks are scanned four at a time with SSE2 where available. Ticks are compared by their
+		/// wrapping difference so tick has to be within 2^31 ticks of the current one.
+		/// Does nothing unless tracking changes. Function must not add or remove components of T.
+		/// </summary>
+		/// <param name="tick">Last tick already seen by the caller.</param>
+		/// <param name="function">Called with a reference to each changed component.</param>
+		template<class Function>
+		void forEachChangedSince(std::uint32_t tick, Function function);
+
+		/// <summary>
+		/// Calls function with references to Fields of every active component, in dense list order, for example
+		/// set.forEachField<&Particle::x, &Particle::vx>([](float& x, float& vx) { x += vx; });
+		/// With SoAStorage the references point into the field arrays, so no component is copied and only the
+		/// arrays of Fields are touched. Stamps the active range while tracking changes, like runUpdate.
+		/// Function must not add or remove components of T.
+		/// </summary>
+		/// <typeparam name="Fields">Pointers to data members of T, listed in the storage for SoAStorage.</typeparam>
+		/// <param name="function">Called with a reference to each field of each active component.</param>
+		template<auto... Fields, class Function>
+		void forEachField(Function function);
+
+		/// <summary>
+		/// Turns recording the ids whose components are added, removed or replaced on or off.
+		/// Off by default. Turning it off empties the lists.
+		/// </summary>
+		/// <param name="enabled">Whether to record.</param>
+		void setObserving(bool enabled);
+
+		/// <summary>
+		/// Returns true if ids are recorded in getEvents().
+		/// </summary>
+		bool isObserving();
+
+		/// <summary>
+		/// Returns the ids recorded since each list was last drained or cleared.
+		/// </summary>
+		ComponentEvents& getEvents();
+
+		/// <summary>
+		/// Writes the sizes of each range, the dense list including the pool, the sparse index and the change
+		/// ticks for Registry::snapshot. Types that can't be written, see CanSnapshot, write an empty set.
+		/// </summary>
+		/// <param name="out">Binary stream to write to.</param>
+		void writeSnapshot(std::ostream& out);
+
+		/// <summary>
+		/// Reads a set written by writeSnapshot for Registry::restore without touching this one. The sizes
+		/// have to fit the dense list, the active flags the active range, the sparse index the dense list as
+		/// described by SparseIndex::validate and tracked ticks the components in use.
+		/// </summary>
+		/// <param name="in">Binary stream to read from.</param>
+		/// <param name="tally">Components per id, one entry for each id counted by the snapshot. The
+		/// components read are added to it.</param>
+		/// <returns>False if the stream ended or failed or holds a set that is inconsistent or can't be read,
+		/// in which case nothing is staged.</returns>
+		bool stageSnapshot(std::istream& in, Vector<int>& tally);
+
+		/// <summary>
+		/// Replaces the cleared set with the one staged by stageSnapshot, after Registry::restore loaded the
+		/// component counts. Sets the signature bits of every id in use and records each as added while
+		/// observing. Change tracking stays as it is, ticks the snapshot lacks start at the current tick.
+		/// </summary>
+		void applySnapshot();
+
+		/// <summary>
+		/// Drops a set staged by stageSnapshot.
+		/// </summary>
+		void discardSnapshot();
+
+		/// <summary>
+		/// For debugging purposes, print out all elements containing components
+		/// </summary>
+		void print();
+	};
+
+	template<class T>
+	inline SparseSet<T>::SparseSet(ComponentCounter& counter, SignatureIndex& signatures, const std::uint32_t& changeTick)
+		: counter(&counter), signatures(&signatures), changeTick(&changeTick)
+	{
+
+	}
+
+	template<class T>
+	inline SparseSet<T>::~SparseSet()
+	{
+
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::iterator SparseSet<T>::begin()
+	{
+		return dense.begin();
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::iterator SparseSet<T>::back()
+	{
+		return dense.begin() + (size_dense_vector - 1);
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::iterator SparseSet<T>::end()
+	{
+		return dense.begin() + size_dense_vector;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::size()
+	{
+		return size_dense_vector;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::numberOfIDs()
+	{
+		return capacity_sparse_vector;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::denseListSize()
+	{
+		return dense.size();
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::empty()
+	{
+		return size_dense_vector == 0;
+	}
+
+	template<class T>
+	inline void SparseSet<T>::clear()
+	{
+		int systemID = System<T>::staticSystemID();
+		for (int i = 0; i < size_dense_vector; i++)
+		{
+			int id = dense[i].belongsToID();
+			counter->removed(id);
+			signatures->reset(id, systemID);
+			if (observing)
+			{
+				events.removed.insert(id);
+			}
+		}
+		dense.clear();
+		dense.resize(0);
+		changeTicks.clear();
+		size_dense_vector = 0;
+		size_active_range = 0;
+		if (owningGroup != nullptr)
+		{
+			owningGroup->cleared(*owningGroup);
+		}
+		sparse.clear();
+		capacity_sparse_vector = 0;
+	}
+
+	template<class T>
+	inline void SparseSet<T>::reset()
+	{
+		// Assigning empty containers frees each block once rather than visiting every element.
+		dense = storage_type();
+		sparse = SparseIndex();
+		changeTicks = Vector<std::uint32_t>();
+		events = ComponentEvents();
+		staged.reset();
+		size_dense_vector = 0;
+		size_active_range = 0;
+		capacity_sparse_vector = 0;
+		if (owningGroup != nullptr)
+		{
+			owningGroup->cleared(*owningGroup);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::reserveIDCapacity(int u)
+	{
+		if (u > capacity_sparse_vector)
+		{
+			sparse.resize(u);
+			capacity_sparse_vector = u;
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::reserveComponentCapacity(int u)
+	{
+		if (u > dense.size())
+		{
+			dense.reserve(u);
+		}
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::has(const int id)
+	{
+		if (id < 0)
+		{
+			return false;
+		}
+
+		if (id >= capacity_sparse_vector)
+		{
+			return false;
+		}
+
+		if (size_dense_vector == 0)
+		{
+			return false;
+		}
+
+		return sparse.contains(id);
+	} // end has(id)
+
+	template<class T>
+	inline void SparseSet<T>::insert(const int id)
+	{
+		if (id < 0)
+		{
+			return;
+		}
+		if (id >= capacity_sparse_vector)
+		{
+			reserveIDCapacity(id + 1);
+		}
+
+		if (dense.size() <= static_cast<size_t>(size_dense_vector))
+		{
+			defaultInsert(id);
+			return;
+		}
+		pooledInsert(id);
+	}
+
+	template<class T>
+	inline void SparseSet<T>::insertRange(const int* ids, int count)
+	{
+		int highestID = -1;
+		int validIDs = 0;
+		for (int i = 0; i < count; i++)
+		{
+			highestID = std::max(highestID, ids[i]);
+			validIDs += ids[i] >= 0;
+		}
+		if (validIDs == 0)
+		{
+			return;
+		}
+		reserveIDCapacity(highestID + 1);
+
+		// Default construct whatever the pool can't cover in one go so inserts reuse those slots.
+		size_t needed = static_cast<size_t>(size_dense_vector) + validIDs;
+		if (dense.size() < needed)
+		{
+			dense.resize(needed);
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			if (ids[i] < 0)
+			{
+				continue;
+			}
+			// initialise can insert into this set as well and use up the slots.
+			if (dense.size() <= static_cast<size_t>(size_dense_vector))
+			{
+				defaultInsert(ids[i]);
+				continue;
+			}
+			pooledInsert(ids[i]);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::defaultInsert(int id)
+	{
+		dense.emplace_back();
+		{
+			// SoAStorage references write back when they go out of scope, which
+			// has to happen before a group can move the component.
+			reference created = dense[size_dense_vector];
+			created.setBelongsToID(id);
+			created.setActive(true);
+			created.T::initialise();
+		}
+
+		sparse.push(id, size_dense_vector);
+		++size_dense_vector;
+		placeInserted();
+		componentAdded(id);
+	}
+
+	template<class T>
+	inline void SparseSet<T>::pooledInsert(int id)
+	{
+		{
+			reference recycaled = dense[size_dense_vector];
+			recycaled.setBelongsToID(id);
+			recycaled.setActive(true);
+			recycaled.T::initialise();
+		}
+
+		sparse.push(id, size_dense_vector);
+		++size_dense_vector;
+		placeInserted();
+		componentAdded(id);
+	}
+
+	template<class T>
+	inline void SparseSet<T>::removePooledObjects()
+	{
+		while (dense.size() > size_dense_vector)
+		{
+			dense.pop_back();
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::insertAnotherToSelf(int id)
+	{
+		defaultInsert(id);
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::pointer SparseSet<T>::ptrGet(const int id)
+	{
+		if (!has(id))
+		{
+			return nullptr;
+		}
+		int position = sparse.first(id);
+		markChangedAt(position);
+		return pointerAt(dense, position);
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::pointer SparseSet<T>::ptrGetAtIndex(const int id, const int index)
+	{
+		if (!has(id))
+		{
+			return nullptr;
+		}
+		if (sparse.count(id) <= index)
+		{
+			return nullptr;
+		}
+		int position = sparse.at(id, index);
+		markChangedAt(position);
+		return pointerAt(dense, position);
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::reference SparseSet<T>::get(const int id)
+	{
+		int position = sparse.first(id);
+		markChangedAt(position);
+		return dense[position];
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::reference SparseSet<T>::getAtIndex(const int id, const int index)
+	{
+		int position = sparse.at(id, index);
+		markChangedAt(position);
+		return dense[position];
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::read_type SparseSet<T>::read(const int id)
+	{
+		return readAt(dense, sparse.first(id));
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::read_type SparseSet<T>::readAtIndex(const int id, const int index)
+	{
+		return readAt(dense, sparse.at(id, index));
+	}
+
+	template<class T>
+	inline typename SparseSet<T>::storage_type& SparseSet<T>::getDenseList()
+	{
+		return dense;
+	}
+
+	template<class T>
+	inline void SparseSet<T>::emplace(const int id, T&& emplaced)
+	{
+		if (id < 0)
+		{
+			return;
+		}
+
+		if (id >= capacity_sparse_vector)
+		{
+			reserveIDCapacity(id + 1);
+		}
+
+		// Earlier removals leave their elements pooled past the used range, the new component takes the first of them.
+		if (dense.size() <= static_cast<size_t>(size_dense_vector))
+		{
+			dense.emplace_back(std::move(emplaced));
+		}
+		else
+		{
+			dense[size_dense_vector] = std::move(emplaced);
+		}
+		dense[size_dense_vector].setBelongsToID(id);
+		sparse.push(id, size_dense_vector);
+		++size_dense_vector;
+		placeInserted();
+		componentAdded(id);
+	}
+
+	template<class T>
+	inline void SparseSet<T>::insertCopy(const int id, T& copy)
+	{
+		if (id < 0)
+		{
+			return;
+		}
+
+		if (id >= capacity_sparse_vector)
+		{
+			reserveIDCapacity(id + 1);
+		}
+
+		if (dense.size() <= static_cast<size_t>(size_dense_vector))
+		{
+			dense.push_back(copy);
+		}
+		else
+		{
+			dense[size_dense_vector] = copy;
+		}
+		dense[size_dense_vector].setBelongsToID(id);
+		sparse.push(id, size_dense_vector);
+		++size_dense_vector;
+		placeInserted();
+		componentAdded(id);
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::eraseWithID(const int id)
+	{
+		if (!removeWithID(id))
+		{
+			return false;
+		}
+		dense.pop_back();
+		return true;
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::eraseAllWithID(const int id)
+	{
+		if (!has(id))
+		{
+			return false;
+		}
+		while (sparse.contains(id))
+		{
+			rem(id);
+			dense.pop_back();
+		}
+		return true;
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::eraseWithIDAtIndex(const int id, int index)
+	{
+		if (!removeWithIDAtIndex(id, index))
+		{
+			return false;
+		}
+		dense.pop_back();
+		return true;
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::removeWithID(const int id)
+	{
+		if (!has(id))
+		{
+			return false;
+		}
+		rem(id);
+		return true;
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::removeAllWithID(const int id)
+	{
+		if (!has(id))
+		{
+			return false;
+		}
+		while (sparse.contains(id))
+		{
+			rem(id);
+		}
+		return true;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::removeAllWithIDs(const int* ids, int count)
+	{
+		int removed = 0;
+		for (int i = 0; i < count; i++)
+		{
+			int id = ids[i];
+			if (!has(id))
+			{
+				continue;
+			}
+			while (sparse.contains(id))
+			{
+				rem(id);
+				++removed;
+			}
+		}
+		return removed;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::eraseAllWithIDs(const int* ids, int count)
+	{
+		int removed = removeAllWithIDs(ids, count);
+		if (removed > 0)
+		{
+			dense.resize(dense.size() - removed);
+		}
+		return removed;
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::removeWithIDAtIndex(const int id, const int index)
+	{
+		if (!has(id))
+		{
+			return false;
+		}
+		if (sparse.count(id) <= index)
+		{
+			return false;
+		}
+		rem(id, index);
+		return true;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::numberOfComponentsWithID(const int id)
+	{
+		if (!has(id))
+		{
+			return 0;
+		}
+		return sparse.count(id);
+	}
+
+	template<class T>
+	inline int SparseSet<T>::getNumberOfActiveComponents()
+	{
+		return size_dense_vector;
+	}
+
+	template<class T>
+	inline int SparseSet<T>::activeRange()
+	{
+		return size_active_range;
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::setActiveWithID(const int id, bool active)
+	{
+		return setActiveWithIDAtIndex(id, 0, active);
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::setActiveWithIDAtIndex(const int id, const int index, bool active)
+	{
+		if (!has(id))
+		{
+			return false;
+		}
+		if (sparse.count(id) <= index)
+		{
+			return false;
+		}
+		setActiveAt(sparse.at(id, index), active);
+		return true;
+	}
+
+	template<class T>
+	inline void SparseSet<T>::setActiveAt(int position, bool active)
+	{
+		{
+			reference component = dense[position];
+			component.setActive(active);
+		}
+
+		if (active)
+		{
+			if (position < size_active_range)
+			{
+				return;
+			}
+			swapPositions(position, size_active_range);
+			++size_active_range;
+			if (owningGroup != nullptr)
+			{
+				owningGroup->changed(*owningGroup, belongsToIDAt(dense, size_active_range - 1));
+			}
+			return;
+		}
+
+		if (position >= size_active_range)
+		{
+			return;
+		}
+		int id = belongsToIDAt(dense, position);
+		// Grouped components are only ever active, so leave the group before leaving the active range.
+		if (owningGroup != nullptr)
+		{
+			position = owningGroup->removing(*owningGroup, id, position);
+		}
+		--size_active_range;
+		swapPositions(position, size_active_range);
+		if (owningGroup != nullptr)
+		{
+			// Id can rejoin the group with another active component of this type.
+			owningGroup->changed(*owningGroup, id);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::runUpdate()
+	{
+		runUpdate(0, size_active_range);
+	}
+
+	template<class T>
+	inline void SparseSet<T>::runUpdate(int begin, int end)
+	{
+		end = std::min(end, size_active_range);
+		forEachInRange(dense, begin, end, [](T& component)
+		{
+			component.T::update();
+		});
+		if (trackChanges && begin < end)
+		{
+			std::fill(changeTicks.begin() + begin, changeTicks.begin() + end, *changeTick);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::replace(const int id, T& copy)
+	{
+		if (!has(id))
+		{
+			return;
+		}
+		copy.setBelongsToID(id);
+		int position = sparse.first(id);
+		dense[position] = copy;
+		markChangedAt(position);
+		if (observing)
+		{
+			events.replaced.insert(id);
+		}
+		setActiveAt(position, copy.isActive());
+	}
+
+	template<class T>
+	inline void SparseSet<T>::replace(const int id, int componentPosition, T& copy)
+	{
+		if (!has(id))
+		{
+			return;
+		}
+		if (componentPosition >= sparse.count(id))
+		{
+			return;
+		}
+		copy.setBelongsToID(id);
+		int position = sparse.at(id, componentPosition);
+		dense[position] = copy;
+		markChangedAt(position);
+		if (observing)
+		{
+			events.replaced.insert(id);
+		}
+		setActiveAt(position, copy.isActive());
+	}
+
+	template<class T>
+	inline void SparseSet<T>::setChangeTracking(bool enabled)
+	{
+		trackChanges = enabled;
+		changeTicks.clear();
+		changeTicks.shrink_to_fit();
+		if (enabled)
+		{
+			changeTicks.resize(size_dense_vector, *changeTick);
+		}
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::isTrackingChanges()
+	{
+		return trackChanges;
+	}
+
+	template<class T>
+	inline std::uint32_t SparseSet<T>::changeTickAt(int position)
+	{
+		return changeTicks[position];
+	}
+
+	template<class T>
+	inline void SparseSet<T>::markChangedAt(int position)
+	{
+		if (trackChanges)
+		{
+			changeTicks[position] = *changeTick;
+		}
+	}
+
+	template<class T>
+	template<auto... Fields, class Function>
+	inline void SparseSet<T>::forEachField(Function function)
+	{
+		static_assert(sizeof...(Fields) > 0, "forEachField needs at least one field");
+		forEachFieldInRange<Fields...>(dense, 0, size_active_range, function);
+		if (trackChanges)
+		{
+			std::fill(changeTicks.begin(), changeTicks.begin() + size_active_range, *changeTick);
+		}
+	}
+
+	template<class T>
+	template<class Function>
+	inline void SparseSet<T>::forEachChangedSince(std::uint32_t tick, Function function)
+	{
+		if (!trackChanges)
+		{
+			return;
+		}
+		int position = 0;
+#if defined(DECS_SSE2)
+		const __m128i since = _mm_set1_epi32(static_cast<int>(tick));
+		const __m128i zero = _mm_setzero_si128();
+		for (; position + 4 <= size_dense_vector; position += 4)
+		{
+			__m128i ticks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(changeTicks.data() + position));
+			int changed = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_sub_epi32(ticks, since), zero)));
+			while (changed != 0)
+			{
+				function(dense[position + lowestBit(changed)]);
+				changed &= changed - 1;
+			}
+		}
+#endif
+		for (; position < size_dense_vector; position++)
+		{
+			if (static_cast<std::int32_t>(changeTicks[position] - tick) > 0)
+			{
+				function(dense[position]);
+			}
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::setObserving(bool enabled)
+	{
+		observing = enabled;
+		if (!enabled)
+		{
+			events.added.clear();
+			events.removed.clear();
+			events.replaced.clear();
+		}
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::isObserving()
+	{
+		return observing;
+	}
+
+	template<class T>
+	inline ComponentEvents& SparseSet<T>::getEvents()
+	{
+		return events;
+	}
+
+	template<class T>
+	inline void SparseSet<T>::writeSnapshot(std::ostream& out)
+	{
+		if constexpr (CanSnapshot<T>::value)
+		{
+			writeValue(out, size_dense_vector);
+			writeValue(out, size_active_range);
+			writeValue(out, capacity_sparse_vector);
+			writeValue(out, static_cast<std::uint64_t>(dense.size()));
+			writeElements(out, dense);
+			sparse.write(out);
+			writeValue(out, static_cast<std::uint8_t>(trackChanges ? 1 : 0));
+			if (trackChanges)
+			{
+				writeList(out, changeTicks);
+			}
+		}
+		else
+		{
+			// Only snapshot while no component is in use, the pool is dropped.
+			writeValue(out, 0);
+			writeValue(out, 0);
+			writeValue(out, 0);
+			writeValue(out, static_cast<std::uint64_t>(0));
+			SparseIndex().write(out);
+			writeValue(out, static_cast<std::uint8_t>(0));
+		}
+	}
+
+	template<class T>
+	inline bool SparseSet<T>::stageSnapshot(std::istream& in, Vector<int>& tally)
+	{
+		discardSnapshot();
+
+		std::unique_ptr<StagedSnapshot> read(new StagedSnapshot());
+		std::uint64_t count;
+		if (!readValue(in, read->usedSize) || !readValue(in, read->activeSize) || !readValue(in, read->sparseCapacity)
+			|| !readValue(in, count) || read->activeSize < 0 || read->activeSize > read->usedSize || read->sparseCapacity < 0
+			|| static_cast<std::uint64_t>(read->usedSize) > count || count > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+		{
+			return false;
+		}
+
+		if constexpr (CanSnapshot<T>::value)
+		{
+			if (!readElements(in, read->dense, static_cast<size_t>(count)))
+			{
+				return false;
+			}
+		}
+		else if (count != 0)
+		{
+			return false;
+		}
+
+		std::uint8_t tracked;
+		if (!read->sparse.read(in) || !readValue(in, tracked) || (tracked != 0 && !readList(in, read->changeTicks)))
+		{
+			return false;
+		}
+		read->tracked = tracked != 0;
+		if (read->tracked && read->changeTicks.size() != static_cast<size_t>(read->usedSize))
+		{
+			return false;
+		}
+
+		// Ids in use must be counted by the snapshot or clear() would miscount them later.
+		storage_type& list = read->dense;
+		for (int position = 0; position < read->usedSize; position++)
+		{
+			int id = belongsToIDAt(list, position);
+			if (id < 0 || static_cast<size_t>(id) >= tally.size() || isActiveAt(list, position) != (position < read->activeSize))
+			{
+				return false;
+			}
+		}
+		if (!read->sparse.validate(read->usedSize, read->sparseCapacity, [&list](int position) { return belongsToIDAt(list, position); }))
+		{
+			return false;
+		}
+
+		for (int position = 0; position < read->usedSize; position++)
+		{
+			++tally[belongsToIDAt(list, position)];
+		}
+		staged = std::move(read);
+		return true;
+	}
+
+	template<class T>
+	inline void SparseSet<T>::applySnapshot()
+	{
+		StagedSnapshot& read = *staged;
+		dense = std::move(read.dense);
+		sparse = std::move(read.sparse);
+		size_dense_vector = read.usedSize;
+		size_active_range = read.activeSize;
+		capacity_sparse_vector = read.sparseCapacity;
+		if (trackChanges && read.tracked)
+		{
+			changeTicks = std::move(read.changeTicks);
+		}
+		else
+		{
+			setChangeTracking(trackChanges);
+		}
+		staged.reset();
+
+		int systemID = System<T>::staticSystemID();
+		for (int position = 0; position < size_dense_vector; position++)
+		{
+			int id = belongsToIDAt(dense, position);
+			signatures->set(id, systemID);
+			if (observing)
+			{
+				events.added.insert(id);
+			}
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::discardSnapshot()
+	{
+		staged.reset();
+	}
+
+	template<class T>
+	inline void SparseSet<T>::print()
+	{
+		if (size_dense_vector == 0)
+		{
+			printf("no components in dense array");
+			printf("\n");
+			return;
+		}
+		for (int i = 0; i < size_dense_vector; i++)
+		{
+			printf("%d, ", dense[i].belongsToID());
+		}
+		printf("\n");
+	}
+
+	template<class T>
+	inline void SparseSet<T>::rem(int id, int index)
+	{
+		int removedComponentPosition = sparse.at(id, index);
+
+		// Grouped components first move to the end of the group so the group stays packed.
+		if (owningGroup != nullptr)
+		{
+			int movedPosition = owningGroup->removing(*owningGroup, id, removedComponentPosition);
+			if (movedPosition != removedComponentPosition)
+			{
+				removedComponentPosition = movedPosition;
+				index = sparse.indexOf(id, movedPosition);
+			}
+		}
+
+		sparse.erase(id, index);
+
+		// Active components fill the hole with the last active component, which moves the hole
+		// to the boundary so the last component in use can fill it like an inactive one.
+		if (removedComponentPosition < size_active_range)
+		{
+			--size_active_range;
+			if (removedComponentPosition != size_active_range)
+			{
+				movePosition(size_active_range, removedComponentPosition);
+				removedComponentPosition = size_active_range;
+			}
+		}
+
+		int lastPosition = size_dense_vector - 1;
+		if (removedComponentPosition != lastPosition)
+		{
+			// The id stored in the dense element points back to its sparse slot, and the last element
+			// in the dense list is always the highest position of its id, so only that slot changes.
+			int lastElementBelongID = belongsToIDAt(dense, lastPosition);
+			sparse.replaceLast(lastElementBelongID, removedComponentPosition);
+			moveElement(dense, lastPosition, removedComponentPosition);
+			if (trackChanges)
+			{
+				changeTicks[removedComponentPosition] = changeTicks[lastPosition];
+			}
+		}
+
+		--size_dense_vector;
+		if (trackChanges)
+		{
+			changeTicks.pop_back();
+		}
+		componentRemoved(id);
+	} // End rem(id);
+
+	template<class T>
+	inline void SparseSet<T>::componentAdded(int id)
+	{
+		counter->added(id);
+		if (observing)
+		{
+			events.added.insert(id);
+		}
+		signatures->set(id, System<T>::staticSystemID());
+		if (owningGroup != nullptr)
+		{
+			owningGroup->changed(*owningGroup, id);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::componentRemoved(int id)
+	{
+		counter->removed(id);
+		if (observing)
+		{
+			events.removed.insert(id);
+		}
+		if (!sparse.contains(id))
+		{
+			signatures->reset(id, System<T>::staticSystemID());
+		}
+		else if (owningGroup != nullptr)
+		{
+			// Id can rejoin the group with another component of this type.
+			owningGroup->changed(*owningGroup, id);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::swapPositions(int a, int b)
+	{
+		if (a == b)
+		{
+			return;
+		}
+		int idA = belongsToIDAt(dense, a);
+		int idB = belongsToIDAt(dense, b);
+
+		swapElements(dense, a, b);
+
+		// Both positions stay with the same id if it owns both.
+		if (idA != idB)
+		{
+			sparse.replace(idA, a, b);
+			sparse.replace(idB, b, a);
+		}
+		if (trackChanges)
+		{
+			std::swap(changeTicks[a], changeTicks[b]);
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::movePosition(int from, int to)
+	{
+		sparse.replace(belongsToIDAt(dense, from), from, to);
+		moveElement(dense, from, to);
+		if (trackChanges)
+		{
+			changeTicks[to] = changeTicks[from];
+		}
+	}
+
+	template<class T>
+	inline void SparseSet<T>::placeInserted()
+	{
+		if (trackChanges)
+		{
+			changeTicks.push_back(*changeTick);
+		}
+		int position = size_dense_vector - 1;
+		if (!isActiveAt(dense, position))
+		{
+			return;
+		}
+		swapPositions(position, size_active_range);
+		++size_active_range;
+	}
+
+} // End sparse
+
+
+
+// SystemBase
+namespace decs
+{
+	/// <summary>
+	/// Base class of SystemState. Used by Registry for when storing 
+	/// a list of systems to update and check when deleting entities.
+	/// Do not construct or use this by itself as it will do nothing.
+	/// </summary>
+	class SystemBase
+	{
+	public:
+		SystemBase();
+
+		virtual ~SystemBase();
+
+		/// <summary>
+		/// Pure virtual function for remove all components that World 
+		/// needs access to through Systems<T>.
+		/// </summary>
+		/// <param name="entityId"></param>
+		/// <returns>True if components removed false if nothing removed.</returns>
+		virtual bool removeAllComponentsWithID(int entityId) = 0;
+
+		/// <summary>
+		/// Pure virtual function for destroying all 
+		/// components that World needs access to through Systems<T>
+		/// </summary>
+		/// <param name="entityId"></param>
+		/// <returns>True if components destroyed, false otherwise.</returns>
+		virtual bool destroyAllComponentsWithID(int entityId) = 0;
+
+		/// <summary>
+		/// Pure virtual function for checking id has component
+		/// that World needs access to through System<T>
+		/// </summary>
+		/// <param name="entityID">ID tag of component</param>
+		/// <returns>True if component with tag exists, false otherwise.</returns>
+		virtual bool hasComponentWithID(int entityID) = 0;
+
+		/// <summary>
+		/// Pure virtual function for adding a default component
+		/// that World needs access to through System<T> when applying commands.
+		/// </summary>
+		/// <param name="entityId">ID tag of component.</param>
+		virtual void addComponentWithID(int entityId) = 0;
+
+		/// <summary>
+		/// Pure virtual function for removing the first component
+		/// that World needs access to through System<T> when applying commands.
+		/// </summary>
+		/// <param name="entityId">ID tag of component.</param>
+		virtual void removeComponentWithID(int entityId) = 0;
+
+		/// <summary>
+		/// Pure virtual function that returns id of System<T> 
+		/// that World needs access to.
+		/// </summary>
+		/// <returns>ID of System<T></returns>
+		virtual int getSystemID() = 0;
+
+		/// <summary>
+		/// Pure virtual function that returns the type name of the components,
+		/// used by World to label profiles and by Registry::snapshot to match types.
+		/// </summary>
+		/// <returns>Name declared by T, see HasSnapshotName, otherwise the name given by typeid.</returns>
+		virtual const char* getName() = 0;
+
+		/// <summary>
+		/// Pure virtual function for update call that World needs.
+		/// </summary>
+		virtual void update() = 0;
+
+		/// <summary>
+		/// Pure virutal function for finding the highest id in use by
+		/// a entity manager that World needs access to.
+		/// </summary>
+		/// <returns>Id of highest id in use.</returns>
+		virtual int highestIDUsed() = 0;
+
+		/// <summary>
+		/// Pure virtual function that returns number of 
+		/// active components in dense list of entity manager. 
+		/// Used for access by World.
+		/// </summary>
+		/// <returns></returns>
+		virtual int getNumberOfActiveComponents() = 0;
+
+		/// <summary>
+		/// Pure virtual function for clearing entitiy manger that needs
+		/// to be accessed by World.
+		/// </summary>
+		virtual void clear() = 0;
+
+		/// <summary>
+		/// Drops every component without per component bookkeeping, see SparseSet::reset.
+		/// </summary>
+		virtual void reset() = 0;
+
+		/// <summary>
+		/// Pure virtual function returning whether the system has declared which
+		/// components its update reads and writes. World only runs systems that have
+		/// declared access in parallel with other systems.
+		/// </summary>
+		/// <returns>True if access has been declared, false otherwise.</returns>
+		virtual bool hasDeclaredAccess() = 0;
+
+		/// <summary>
+		/// Pure virtual function returning the system ids of components read during update.
+		/// </summary>
+		/// <returns>System ids of components read.</returns>
+		virtual const std::vector<int>& getReadAccess() = 0;
+
+		/// <summary>
+		/// Pure virtual function returning the system ids of components written during update.
+		/// </summary>
+		/// <returns>System ids of components written.</returns>
+		virtual const std::vector<int>& getWriteAccess() = 0;
+
+		/// <summary>
+		/// Pure virtual function returning whether Registry::snapshot can write the components.
+		/// Types that aren't CanSnapshot are only fine while none of their components are in use.
+		/// </summary>
+		/// <returns>True if the components can be written, false otherwise.</returns>
+		virtual bool canSnapshot() = 0;
+
+		/// <summary>
+		/// Pure virtual function writing the components for Registry::snapshot.
+		/// </summary>
+		/// <param name="out">Binary stream to write to.</param>
+		virtual void writeSnapshot(std::ostream& out) = 0;
+
+		/// <summary>
+		/// Pure virtual function reading and checking components for Registry::restore without replacing any.
+		/// </summary>
+		/// <param name="in">Binary stream to read from.</param>
+		/// <param name="tally">Components per id the snapshot counted, the components read are added.</param>
+		/// <returns>True if the components were read and are consistent, false otherwise.</returns>
+		virtual bool stageSnapshot(std::istream& in, Vector<int>& tally) = 0;
+
+		/// <summary>
+		/// Pure virtual function replacing the cleared components with the staged ones.
+		/// </summary>
+		virtual void applySnapshot() = 0;
+
+		/// <summary>
+		/// Pure virtual function dropping the staged components.
+		/// </summary>
+		virtual void discardSnapshot() = 0;
+	};
+
+	inline SystemBase::SystemBase() {}
+
+	inline SystemBase::~SystemBase() {}
+
+} // End SystemBase
+
+namespace decs
+{
+	/// <summary>
+	/// Fixed size pool of worker threads used by World to run systems in parallel.
+	/// Threads waiting on work with waitFor run pending tasks themselves, so tasks can
+	/// submit and wait on more tasks without running out of workers.
+	/// </summary>
+	class ThreadPool
+	{
+	public:
+		/// <summary>
+		/// Starts threadCount worker threads.
+		/// </summary>
+		/// <param name="threadCount">Number of worker threads to start.</param>
+		/// <param name="threadStarted">Called on each worker thread before it runs any task. Can be empty.</param>
+		explicit ThreadPool(int threadCount, std::function<void()> threadStarted = std::function<void()>());
+
+		/// <summary>
+		/// Finishes all queued tasks and joins the worker threads.
+		/// </summary>
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// <summary>
+		/// Returns the number of worker threads.
+		/// </summary>
+		/// <returns>Number of worker threads.</returns>
+		int threadCount();
+
+		/// <summary>
+		/// Queues task to be run by the next free thread.
+		/// </summary>
+		/// <param name="task">Task to be run.</param>
+		void submit(std::function<void()> task);
+
+		/// <summary>
+		/// Runs one queued task on the calling thread if there is one.
+		/// </summary>
+		/// <returns>True if a task was run, false if the queue was empty.</returns>
+		bool runPendingTask();
+
+		/// <summary>
+		/// Runs queued tasks on the calling thread until remaining reaches 0.
+		/// </summary>
+		/// <param name="remaining">Counter decremented by the tasks being waited on.</param>
+		void waitFor(std::atomic<int>& remaining);
+
+		/// <summary>
+		/// Splits [begin, end) into chunks of chunkSize and calls function(chunkBegin, chunkEnd) for every
+		/// chunk on the worker threads and the calling thread. Each thread starts on its own share of
+		/// the chunks and steals chunks from the other shares once its own runs out.
+		/// Returns once every chunk is done.
+		/// </summary>
+		/// <param name="begin">First index of the range.</param>
+		/// <param name="end">One past the last index of the range.</param>
+		/// <param name="chunkSize">Number of indices handed out at a time.</param>
+		/// <param name="function">Called with the bounds of each chunk.</param>
+		template<class Function>
+		void parallelFor(int begin, int end, int chunkSize, Function function);
+
+	private:
+		/// <summary>
+		/// Share of chunks owned by one thread during parallelFor. Kept on its own cache line
+		/// so threads taking chunks from different shares don't contend.
+		/// </summary>
+		struct alignas(64) ChunkRange
+		{
+			std::atomic<int> next;
+			int last;
+		};
+
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> tasks;
+		std::mutex taskMutex;
+		std::condition_variable taskAvailable;
+		bool stopping = false;
+		std::function<void()> threadStarted;
+
+		void workerLoop();
+	};
+
+	inline ThreadPool::ThreadPool(int threadCount, std::function<void()> threadStarted)
+		: threadStarted(std::move(threadStarted))
+	{
+		for (int i = 0; i < threadCount; i++)
+		{
+			workers.emplace_back(&ThreadPool::workerLoop, this);
+		}
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			stopping = true;
+		}
+		taskAvailable.notify_all();
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	inline int ThreadPool::threadCount()
+	{
+		return static_cast<int>(workers.size());
+	}
+
+	inline void ThreadPool::submit(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			tasks.push_back(std::move(task));
+		}
+		taskAvailable.notify_one();
+	}
+
+	inline bool ThreadPool::runPendingTask()
+	{
+		std::function<void()> task;
+		{
+			std::lock_guard<std::mutex> lock(taskMutex);
+			if (tasks.empty())
+			{
+				return false;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+		return true;
+	}
+
+	inline void ThreadPool::waitFor(std::atomic<int>& remaining)
+	{
+		while (remaining.load() > 0)
+		{
+			if (!runPendingTask())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	template<class Function>
+	inline void ThreadPool::parallelFor(int begin, int end, int chunkSize, Function function)
+	{
+		int chunkCount = (end - begin + chunkSize - 1) / chunkSize;
+		int participants = std::min(threadCount() + 1, chunkCount);
+		if (participants <= 1)
+		{
+			function(begin, end);
+			return;
+		}
+
+		std::unique_ptr<ChunkRange[]> ranges(new ChunkRange[participants]);
+		for (int i = 0; i < participants; i++)
+		{
+			ranges[i].next.store(chunkCount * i / participants);
+			ranges[i].last = chunkCount * (i + 1) / participants;
+		}
+
+		auto work = [&](int self)
+		{
+			// Own share first, then steal from the others.
+			for (int offset = 0; offset < participants; offset++)
+			{
+				ChunkRange& range = ranges[(self + offset) % participants];
+				int chunk;
+				while ((chunk = range.next.fetch_add(1)) < range.last)
+				{
+					int chunkBegin = begin + chunk * chunkSize;
+					function(chunkBegin, std::min(chunkBegin + chunkSize, end));
+				}
+			}
+		};
+
+		std::atomic<int> remaining(participants - 1);
+		for (int i = 1; i < participants; i++)
+		{
+			submit([&work, &remaining, i]
+			{
+				work(i);
+				remaining.fetch_sub(1);
+			});
+		}
+		work(0);
+		waitFor(remaining);
+	}
+
+	inline void ThreadPool::workerLoop()
+	{
+		if (threadStarted)
+		{
+			threadStarted();
+		}
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(taskMutex);
+				taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+				if (tasks.empty())
+				{
+					return;
+				}
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			task();
+		}
+	}
+} // End ThreadPool
+
+namespace decs
+{
+	/// <summary>
+	/// Handle to an entity. Pairs the id with the generation the id had when the
+	/// entity was created. World bumps the generation each time an id is reused,
+	/// so a handle kept after its entity was destroyed no longer matches and
+	/// System<T> calls taking an Entity ignore it.
+	/// </summary>
+	struct Entity
+	{
+		int id = -1;
+		unsigned int generation = 0;
+	};
+
+	inline bool operator==(const Entity& a, const Entity& b)
+	{
+		return a.id == b.id && a.generation == b.generation;
+	}
+
+	inline bool operator!=(const Entity& a, const Entity& b)
+	{
+		return !(a == b);
+	}
+} // End Entity
+
+namespace decs
+{
+	class Registry;
+	template<class T> class SystemState;
+	template<class... Owned> class GroupState;
+
+	/// <summary>
+	/// Records structural changes made while systems update so they can be applied
+	/// later on one thread. Every thread has its own buffer in each Registry, get it with
+	/// World::getCommandBuffer() or Registry::getCommandBuffer(). Recording needs no locks.
+	/// 
+	/// All buffers of a Registry are applied together by destroyMarked, sorted by entity id,
+	/// so the result doesn't depend on which thread recorded what. For each entity
+	/// adds are applied first, then removes. If the entity is destroyed its other
+	/// commands are dropped and it is destroyed once.
+	/// </summary>
+	class CommandBuffer
+	{
+	public:
+		/// <summary>
+		/// Kind of a recorded command. Commands of one entity are applied in this order.
+		/// </summary>
+		enum class CommandType
+		{
+			AddComponent,
+			RemoveComponent,
+			DestroyPooledEntity,
+			DestroyEntity
+		};
+
+		/// <summary>
+		/// One recorded command. systemID is -1 for commands on the whole entity.
+		/// </summary>
+		struct Command
+		{
+			int entityID;
+			CommandType type;
+			int systemID;
+		};
+
+		/// <summary>
+		/// Registers the buffer with the registry bound to the calling thread so its commands are applied.
+		/// </summary>
+		CommandBuffer();
+
+		/// <summary>
+		/// Registers the buffer with registry so its commands are applied. The buffer must not outlive registry.
+		/// </summary>
+		/// <param name="registry">Registry the commands are applied to.</param>
+		explicit CommandBuffer(Registry& registry);
+
+		/// <summary>
+		/// Hands commands not applied yet to its Registry and unregisters the buffer.
+		/// </summary>
+		~CommandBuffer();
+
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+		/// <summary>
+		/// Returns a new entity id straight away. Safe to call while systems update in parallel.
+		/// </summary>
+		/// <returns>Id for use.</returns>
+		int createEntity();
+
+		/// <summary>
+		/// Records entity to be destroyed. Marking an entity again straight after is ignored.
+		/// </summary>
+		/// <param name="entityID">ID of components to be removed.</param>
+		/// <param name="poolComponents">Whether to store
+		/// components in a pool or not. True by default.</param>
+		void destroyEntity(int entityID, bool poolComponents = true);
+
+		/// <summary>
+		/// Records a default component T to be added to entity.
+		/// It is set to active and initialised when applied.
+		/// </summary>
+		/// <param name="entityID">ID tag of component.</param>
+		template<class T>
+		void addComponent(int entityID);
+
+		/// <summary>
+		/// Records the first component T of entity to be removed into a pool.
+		/// </summary>
+		/// <param name="entityID">ID tag of component.</param>
+		template<class T>
+		void removeComponent(int entityID);
+
+		/// <summary>
+		/// Returns the recorded commands in the order they were recorded.
+		/// </summary>
+		/// <returns>Recorded commands.</returns>
+		Vector<Command>& getCommands();
+
+	private:
+		Registry& registry;
+		Vector<Command> commands;
+	};
+
+	inline Vector<CommandBuffer::Command>& CommandBuffer::getCommands()
+	{
+		return commands;
+	}
+
+	inline void CommandBuffer::destroyEntity(int entityID, bool poolComponents)
+	{
+		CommandType type = poolComponents ? CommandType::DestroyPooledEntity : CommandType::DestroyEntity;
+		// Components of one entity tend to mark it in a row, record it once. Destroys
+		// recorded further apart or by other threads are merged by destroyMarked.
+		if (!commands.empty() && commands.back().entityID == entityID && commands.back().type == type)
+		{
+			return;
+		}
+		commands.push_back({ entityID, type, -1 });
+	}
+
+	template<class T>
+	inline void CommandBuffer::addComponent(int entityID)
+	{
+		commands.push_back({ entityID, CommandType::AddComponent, System<T>::staticSystemID() });
+	}
+
+	template<class T>
+	inline void CommandBuffer::removeComponent(int entityID)
+	{
+		commands.push_back({ entityID, CommandType::RemoveComponent, System<T>::staticSystemID() });
+	}
+} // End CommandBuffer
+
+namespace decs
+{
+	/// <summary>
+	/// Timing of one system in a profiled frame.
+	/// </summary>
+	struct SystemProfile
+	{
+		int systemID;
+
+		/// <summary>
+		/// Type name of the components the system updates.
+		/// </summary>
+		const char* name;
+
+		/// <summary>
+		/// Components in use when the update started.
+		/// </summary>
+		int componentCount;
+
+		/// <summary>
+		/// Profiler::threadIndex() of the thread that ran the update.
+		/// </summary>
+		int thread;
+
+		/// <summary>
+		/// Nanoseconds since the profiler was created when the update started, and how long it took.
+		/// </summary>
+		std::int64_t start;
+		std::int64_t duration;
+	};
+
+	/// <summary>
+	/// One update of a Registry. Times are nanoseconds, start is measured from the creation of the profiler.
+	/// </summary>
+	struct FrameProfile
+	{
+		std::uint64_t frame;
+		std::int64_t start;
+		std::int64_t duration;
+
+		/// <summary>
+		/// Profiler::threadIndex() of the thread that called update.
+		/// </summary>
+		int thread;
+
+		/// <summary>
+		/// Time spent applying commands and destroying entities at the end of the update.
+		/// </summary>
+		std::int64_t destroyMarkedStart;
+		std::int64_t destroyMarkedDuration;
+
+		/// <summary>
+		/// Components added and removed during the frame, directly or through commands.
+		/// </summary>
+		std::uint64_t structuralChanges;
+
+		/// <summary>
+		/// Every system in update order.
+		/// </summary>
+		Vector<SystemProfile> systems;
+	};
+
+	/// <summary>
+	/// Records a FrameProfile for each update of a Registry into a ring of the last frameCapacity frames,
+	/// see Registry::setProfiling. Times come from std::chrono::steady_clock.
+	/// 
+	/// Recording takes no locks. Systems updating in parallel write to their own SystemProfile and a frame
+	/// is published by bumping an atomic count once it is complete. Frames are read between updates, or
+	/// while one runs from another thread as long as they are fewer than frameCapacity - 1 frames old.
+	/// </summary>
+	class Profiler
+	{
+	public:
+		/// <param name="frameCapacity">Number of frames kept before the oldest is overwritten.</param>
+		explicit Profiler(int frameCapacity = 256);
+
+		/// <summary>
+		/// Returns steady_clock nanoseconds since the profiler was created.
+		/// </summary>
+		std::int64_t now() const;
+
+		/// <summary>
+		/// Returns a small number unique to the calling thread, handed out in order of first use.
+		/// </summary>
+		static int threadIndex();
+
+		/// <summary>
+		/// Starts recording the next frame with room for systemCount systems. Called by Registry::update.
+		/// </summary>
+		void beginFrame(int systemCount, std::uint64_t changeCount);
+
+		/// <summary>
+		/// Records the update of the system at index in the frame being recorded.
+		/// Can be called from several threads for different indices.
+		/// </summary>
+		void recordSystem(int index, int systemID, const char* name, int componentCount, std::int64_t start, std::int64_t end);
+
+		/// <summary>
+		/// Finishes the frame being recorded and publishes it.
+		/// </summary>
+		void endFrame(std::int64_t destroyMarkedStart, std::int64_t destroyMarkedEnd, std::uint64_t changeCount);
+
+		/// <summary>
+		/// Returns the number of frames kept.
+		/// </summary>
+		int getFrameCapacity() const;
+
+		/// <summary>
+		/// Returns the number of frames recorded since the profiler was created.
+		/// </summary>
+		std::uint64_t getFramesRecorded() const;
+
+		/// <summary>
+		/// Returns the number of frames that can be read with getFrame.
+		/// </summary>
+		int getFrameCount() const;
+
+		/// <summary>
+		/// Returns a recorded frame, 0 being the most recent. Returns nullptr if framesAgo isn't kept.
+		/// </summary>
+		const FrameProfile* getFrame(int framesAgo) const;
+
+		/// <summary>
+		/// Returns the system that took the longest in a recorded frame or nullptr if there is none.
+		/// </summary>
+		const SystemProfile* getSlowestSystem(int framesAgo) const;
+
+		/// <summary>
+		/// Returns the number of kept frames that took longer than budget nanoseconds.
+		/// </summary>
+		int countFramesOverBudget(std::int64_t budget) const;
+
+		/// <summary>
+		/// Writes the kept frames as Chrome trace event JSON, open it in chrome://tracing or Perfetto.
+		/// Frames and destroyMarked are on the thread that called update, systems on the thread that ran them.
+		/// </summary>
+		void writeChromeTrace(std::ostream& out) const;
+
+	private:
+		std::chrono::steady_clock::time_point epoch;
+		Vector<FrameProfile> frames;
+		std::atomic<std::uint64_t> framesRecorded;
+		FrameProfile* recording = nullptr;
+		std::uint64_t changesAtStart = 0;
+
+		static void writeEscaped(std::ostream& out, const char* text);
+	};
+
+	inline Profiler::Profiler(int frameCapacity)
+		: epoch(std::chrono::steady_clock::now()), frames(std::max(frameCapacity, 2)), framesRecorded(0)
+	{
+
+	}
+
+	inline std::int64_t Profiler::now() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	inline int Profiler::threadIndex()
+	{
+		static std::atomic<int> threadCount(0);
+		thread_local int index = threadCount.fetch_add(1);
+		return index;
+	}
+
+	inline void Profiler::beginFrame(int systemCount, std::uint64_t changeCount)
+	{
+		std::uint64_t frame = framesRecorded.load(std::memory_order_relaxed);
+		recording = &frames[frame % frames.size()];
+		recording->frame = frame;
+		recording->thread = threadIndex();
+		recording->start = now();
+		recording->duration = 0;
+		recording->destroyMarkedStart = 0;
+		recording->destroyMarkedDuration = 0;
+		recording->structuralChanges = 0;
+		// Only allocates when there are more systems than any frame in this slot had.
+		recording->systems.resize(systemCount);
+		changesAtStart = changeCount;
+	}
+
+	inline void Profiler::recordSystem(int index, int systemID, const char* name, int componentCount, std::int64_t start, std::int64_t end)
+	{
+		SystemProfile& profile = recording->systems[index];
+		profile.systemID = systemID;
+		profile.name = name;
+		profile.componentCount = componentCount;
+		profile.thread = threadIndex();
+		profile.start = start;
+		profile.duration = end - start;
+	}
+
+	inline void Profiler::endFrame(std::int64_t destroyMarkedStart, std::int64_t destroyMarkedEnd, std::uint64_t changeCount)
+	{
+		recording->destroyMarkedStart = destroyMarkedStart;
+		recording->destroyMarkedDuration = destroyMarkedEnd - destroyMarkedStart;
+		recording->duration = destroyMarkedEnd - recording->start;
+		recording->structuralChanges = changeCount - changesAtStart;
+		recording = nullptr;
+		framesRecorded.fetch_add(1, std::memory_order_release);
+	}
+
+	inline int Profiler::getFrameCapacity() const
+	{
+		return static_cast<int>(frames.size());
+	}
+
+	inline std::uint64_t Profiler::getFramesRecorded() const
+	{
+		return framesRecorded.load(std::memory_order_acquire);
+	}
+
+	inline int Profiler::getFrameCount() const
+	{
+		return static_cast<int>(std::min<std::uint64_t>(getFramesRecorded(), frames.size()));
+	}
+
+	inline const FrameProfile* Profiler::getFrame(int framesAgo) const
+	{
+		if (framesAgo < 0 || framesAgo >= getFrameCount())
+		{
+			return nullptr;
+		}
+		std::uint64_t frame = getFramesRecorded() - 1 - framesAgo;
+		return &frames[frame % frames.size()];
+	}
+
+	inline const SystemProfile* Profiler::getSlowestSystem(int framesAgo) const
+	{
+		const FrameProfile* frame = getFrame(framesAgo);
+		if (frame == nullptr || frame->systems.empty())
+		{
+			return nullptr;
+		}
+		return &*std::max_element(frame->systems.begin(), frame->systems.end(),
+			[](const SystemProfile& a, const SystemProfile& b)
+		{
+			return a.duration < b.duration;
+		});
+	}
+
+	inline int Profiler::countFramesOverBudget(std::int64_t budget) const
+	{
+		int count = 0;
+		int frameCount = getFrameCount();
+		for (int i = 0; i < frameCount; i++)
+		{
+			count += getFrame(i)->duration > budget;
+		}
+		return count;
+	}
+
+	inline void Profiler::writeChromeTrace(std::ostream& out) const
+	{
+		// Trace event times are microseconds, keep nanoseconds as decimals instead of exponents.
+		std::ios_base::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		out.setf(std::ios_base::fixed, std::ios_base::floatfield);
+		out.precision(3);
+
+		out << "{\"traceEvents\":[";
+		bool first = true;
+		for (int i = getFrameCount() - 1; i >= 0; i--)
+		{
+			const FrameProfile& frame = *getFrame(i);
+			out << (first ? "\n" : ",\n");
+			first = false;
+			out << "{\"name\":\"Frame " << frame.frame << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":" << frame.thread
+				<< ",\"ts\":" << frame.start / 1000.0 << ",\"dur\":" << frame.duration / 1000.0
+				<< ",\"args\":{\"structuralChanges\":" << frame.structuralChanges << "}}";
+			out << ",\n{\"name\":\"destroyMarked\",\"cat\":\"destroyMarked\",\"ph\":\"X\",\"pid\":0,\"tid\":" << frame.thread
+				<< ",\"ts\":" << frame.destroyMarkedStart / 1000.0 << ",\"dur\":" << frame.destroyMarkedDuration / 1000.0 << "}";
+			for (const SystemProfile& system : frame.systems)
+			{
+				out << ",\n{\"name\":\"";
+				writeEscaped(out, system.name);
+				out << "\",\"cat\":\"system\",\"ph\":\"X\",\"pid\":0,\"tid\":" << system.thread
+					<< ",\"ts\":" << system.start / 1000.0 << ",\"dur\":" << system.duration / 1000.0
+					<< ",\"args\":{\"systemID\":" << system.systemID << ",\"components\":" << system.componentCount << "}}";
+			}
+		}
+		out << "\n]}\n";
+
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	inline void Profiler::writeEscaped(std::ostream& out, const char* text)
+	{
+		for (; *text != '\0'; text++)
+		{
+			if (*text == '"' || *text == '\\')
+			{
+				out << '\\';
+			}
+			out << *text;
+		}
+	}
+} // End Profiler
+
+namespace decs
+{
+	/// <summary>
+	/// Everything one simulation needs: the components and update settings of every component type,
+	/// groups, the id pool, command buffers, delta time and the update schedule and threads.
+	/// Registries share no state, so independent worlds can each be updated on their own thread.
+	/// 
+	/// World, and System<T>, View and Group handles made without a registry, use the registry bound
+	/// to the calling thread. That is the default registry unless bind or a Scope says otherwise.
+	/// update and destroyMarked bind the registry while they run and its worker threads are bound to
+	/// it, so component code calling World works on the registry being updated.
+	/// 
+	/// Component type ids from System<T>::staticSystemID() are the same in every registry so
+	/// Signatures work with all of them. Memory::resource() is used by every registry.
+	/// </summary>
+	class Registry
+	{
+	public:
+		/// <summary>
+		/// Binds a registry to the calling thread until destroyed, then binds the previous one again.
+		/// </summary>
+		class Scope
+		{
+		public:
+			explicit Scope(Registry& registry);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			Registry* previous;
+		};
+
+		Registry();
+
+		/// <summary>
+		/// Joins the threads and destroys every component, group and thread command buffer.
+		/// CommandBuffers constructed by the user must be destroyed first.
+		/// </summary>
+		~Registry();
+
+		Registry(const Registry&) = delete;
+		Registry& operator=(const Registry&) = delete;
+
+		/// <summary>
+		/// Returns the registry used by threads that have not bound another one.
+		/// </summary>
+		static Registry& getDefault();
+
+		/// <summary>
+		/// Returns the registry bound to the calling thread.
+		/// </summary>
+		static Registry& current();
+
+		/// <summary>
+		/// Binds registry to the calling thread. nullptr binds the default registry.
+		/// </summary>
+		/// <param name="registry">Registry to bind or nullptr.</param>
+		/// <returns>Registry bound before, nullptr if it was the default.</returns>
+		static Registry* bind(Registry* registry);
+
+		/// <summary>
+		/// Returns a new component type id. Called once per type by System<T>::staticSystemID.
+		/// </summary>
+		static int createNewSystemID();
+
+		/// <summary>
+		/// Returns a new group type id. Called once per type by GroupState::groupID.
+		/// </summary>
+		static int createNewGroupID();
+
+		/// <summary>
+		/// Returns the components and settings of T, creating them on first use. Types are
+		/// updated in the order they are first used. Create them before updating in parallel.
+		/// </summary>
+		template<class T>
+		SystemState<T>& getSystemState();
+
+		/// <summary>
+		/// Returns the components of T, creating them on first use.
+		/// </summary>
+		template<class T>
+		SparseSet<T>& getSparseSet();
+
+		/// <summary>
+		/// Returns the group of the owned types, creating it on first use.
+		/// </summary>
+		template<class... Owned>
+		GroupState<Owned...>& getGroupState();
+
+		/// <summary>
+		/// Set new delta time. Do this at the begininng of every frame to make sure your programs are frame rate
+		/// independant;
+		/// </summary>
+		/// <param name="dt">delta time float to be passed</param>
+		void setDeltaTime(float dt);
+
+		/// <summary>
+		/// Get delta time of current frame
+		/// </summary>
+		float getDeltaTime();
+
+		/// <summary>
+		/// Returns ID to be used. Will use one from reusable
+		/// ids if one is available. Safe to call while systems update in parallel.
+		/// </summary>
+		/// <returns>Id for use.</returns>
+		int createNewID();
+
+		/// <summary>
+		/// Returns amount ids for use, taking the pool lock once. Reusable ids are handed
+		/// out first and the rest are a contiguous range of new ids.
+		/// </summary>
+		/// <param name="amount">Number of ids to create.</param>
+		/// <returns>Ids for use.</returns>
+		Vector<int> createNewIDs(int amount);
+
+		/// <summary>
+		/// Writes amount ids for use to ids without allocating, taking the pool lock once.
+		/// Reusable ids are handed out first and the rest are a contiguous range of new ids.
+		/// </summary>
+		/// <param name="ids">Array of at least amount ints to write the ids to.</param>
+		/// <param name="amount">Number of ids to create.</param>
+		void createNewIDs(int* ids, int amount);
+
+		/// <summary>
+		/// Returns a handle to a new entity. Uses createNewID for the id.
+		/// </summary>
+		/// <returns>Handle of the new entity.</returns>
+		Entity createEntity();
+
+		/// <summary>
+		/// Returns the handle of the entity currently using id.
+		/// </summary>
+		/// <param name="entityID">ID handed out by createNewID.</param>
+		/// <returns>Handle of the entity using id.</returns>
+		Entity getEntity(int entityID);
+
+		/// <summary>
+		/// Returns false once the entity has been destroyed and its id put back in the pool.
+		/// Can be called while systems update in parallel as long as no other
+		/// thread creates an id that hasn't been used before at the same time.
+		/// </summary>
+		/// <param name="entity">Handle of the entity.</param>
+		/// <returns>True if the handle still refers to a live entity.</returns>
+		bool isAlive(Entity entity);
+
+		/// <summary>
+		/// Calls update on all systems that have
+		/// set allowUpdate to true.
+		/// 
+		/// If more than one thread is set with setThreadCount, systems that have declared
+		/// their access run at the same time as other systems they do not conflict with.
+		/// Systems that conflict still run in the order they were added.
+		/// </summary>
+		void update();
+
+		/// <summary>
+		/// Sets the number of threads used by update, including the calling thread.
+		/// 1 or less runs every system on the calling thread. This is the default.
+		/// </summary>
+		/// <param name="threadCount">Number of threads to use.</param>
+		void setThreadCount(int threadCount);
+
+		/// <summary>
+		/// Returns the number of threads used by update, including the calling thread.
+		/// </summary>
+		/// <returns>Number of threads used by update.</returns>
+		int getThreadCount();
+
+		/// <summary>
+		/// Returns the pool used by update or nullptr if update runs on one thread.
+		/// </summary>
+		/// <returns>Thread pool or nullptr.</returns>
+		ThreadPool* getThreadPool();
+
+		/// <summary>
+		/// Turns recording a FrameProfile on every update on or off. Off by default, when off update
+		/// only checks a pointer per system. Turning it on starts an empty profiler.
+		/// Don't call while update runs.
+		/// </summary>
+		/// <param name="enabled">Whether to profile updates.</param>
+		/// <param name="frameCapacity">Number of frames the profiler keeps.</param>
+		void setProfiling(bool enabled, int frameCapacity = 256);
+
+		/// <summary>
+		/// Returns the profiler recording updates or nullptr if profiling is off.
+		/// </summary>
+		/// <returns>Profiler or nullptr.</returns>
+		Profiler* getProfiler();
+
+		/// <summary>
+		/// Returns the tick changes to tracked components are stamped with. update starts a new tick every frame.
+		/// </summary>
+		/// <returns>Current change tick.</returns>
+		std::uint32_t getChangeTick();
+
+		/// <summary>
+		/// Starts a new change tick and returns the one that ended. Every change made so far is stamped
+		/// at or before the returned tick and every later change after it, so a reader can keep the returned
+		/// tick and pass it to forEachChangedSince on its next read. Don't call from several threads at once.
+		/// </summary>
+		/// <returns>Tick that ended.</returns>
+		std::uint32_t advanceChangeTick();
+
+		/// <summary>
+		/// Tells the registry the declared access of a system changed and the update
+		/// schedule needs rebuilding. Called by System<T> automatically.
+		/// </summary>
+		void accessChanged();
+
+		/// <summary>
+		/// Returns the command buffer of the calling thread.
+		/// </summary>
+		/// <returns>Command buffer of the calling thread.</returns>
+		CommandBuffer& getCommandBuffer();
+
+		/// <summary>
+		/// Marks entity to be destroyed.
+		/// If using built in update these entites are removed
+		/// or destroyed at the end of the update cycle.
+		/// Recorded in the command buffer of the calling thread.
+		/// </summary>
+		/// <param name="entityID">ID of components to be removed.</param>
+		/// <param name="poolComponents">Whether to store
+		/// components in a pool or not. True by default.</param>
+		void destroyEntity(int entityID, bool poolComponents = true);
+
+		/// <summary>
+		/// Marks entity to be destroyed. Does nothing if the handle is stale.
+		/// </summary>
+		/// <param name="entity">Handle of the entity.</param>
+		/// <param name="poolComponents">Whether to store
+		/// components in a pool or not. True by default.</param>
+		void destroyEntity(Entity entity, bool poolComponents = true);
+
+		/// <summary>
+		/// Marks all ids and components for destruction.
+		/// If using built in update components will be destroyed at
+		/// the end of the update cycle.
+		/// </summary>
+		/// <param name="poolComponents">Whether to store
+		/// components for reuse or not. Set to false by default.</param>
+		void destroyAllEntities(bool poolComponents = false);
+
+		/// <summary>
+		/// Destroys every entity and component at once, for example between levels. Unlike
+		/// destroyAllEntities nothing is removed one by one: no hooks or events run, every system
+		/// drops its dense and sparse lists whole, and the id pool, counter, signatures and recorded
+		/// commands are replaced by empty ones. Systems, groups and their settings stay.
+		/// O(systems + sparse pages) when every component type is trivially destructible.
+		/// Ids start from 0 again, so Entity handles from before the reset must not be used.
+		/// Must not be called while update runs.
+		/// </summary>
+		void reset();
+
+		/// <summary>
+		/// Places ids whose last component was removed into the id pool to be reused.
+		/// Takes time proportional to the number of orphans, not the number of ids.
+		/// destroyMarked does this automatically.
+		/// </summary>
+		void destroyOrphanedEntities();
+
+		/// <summary>
+		/// Destroys marked components and applies every other command
+		/// recorded in command buffers. This is called automatically
+		/// with the built in update.
+		/// 
+		/// When using custom updates this needs to be
+		/// called by the user.
+		/// </summary>
+		void destroyMarked();
+
+		/// <summary>
+		/// Returns what the next availble id will be but doesn't increment.
+		/// Instead use createNewId() to assign a new id as this will use a pool and
+		/// auto increment to the next available.
+		/// </summary>
+		/// <returns>an int that the next available id will be not including those in the pool</returns>
+		int getNextAvailableEntityID();
+
+		/// <summary>
+		/// Returns true if entity has every component type in include and none in exclude.
+		/// Build signatures once with Signature::of<A, B>() and reuse them.
+		/// </summary>
+		/// <param name="entityID">ID of entity.</param>
+		/// <param name="include">Component types entity must have.</param>
+		/// <param name="exclude">Component types entity must not have.</param>
+		/// <returns>True if entity matches.</returns>
+		bool matches(int entityID, const Signature& include, const Signature& exclude = Signature());
+
+		/// <summary>
+		/// Fills ids with every entity that has all component types in include
+		/// and none in exclude, in ascending order.
+		/// </summary>
+		/// <param name="include">Component types entities must have.</param>
+		/// <param name="exclude">Component types entities must not have.</param>
+		/// <param name="ids">Cleared then filled with the matching ids.</param>
+		void query(const Signature& include, const Signature& exclude, std::vector<int>& ids);
+
+		/// <summary>
+		/// Version of the format written by snapshot. restore refuses any other version.
+		/// </summary>
+		static constexpr std::uint32_t snapshot_version = 1;
+
+		/// <summary>
+		/// Writes the id pool, component counts, change tick and every component type used with this registry
+		/// in a versioned binary format. Each type writes its dense list including the pool, its sparse index
+		/// and its change ticks. Trivially copyable components are written as raw bytes in one go, other types
+		/// need the hooks described by HasSerializer. Layouts are written as they are in memory, so snapshots
+		/// are read back by the same build on the same platform.
+		/// 
+		/// Commands not yet applied are not written, take snapshots between updates and never during one.
+		/// </summary>
+		/// <param name="out">Binary stream to write to.</param>
+		/// <returns>False if the stream failed, or without writing anything if a type that can't be
+		/// written has components in use.</returns>
+		bool snapshot(std::ostream& out);
+
+		/// <summary>
+		/// Replaces every component, the id pool and the change tick with a snapshot. Types are matched by name,
+		/// see HasSnapshotName, so every type in the snapshot has to have been used with this registry first, for
+		/// example by constructing its System<T>. Types missing from the snapshot are left empty. Owning groups are
+		/// packed again, commands not yet applied are dropped and per type settings such as update, observing and
+		/// change tracking are kept.
+		/// 
+		/// The whole snapshot is read and checked before anything is replaced: the id pool, the component counts
+		/// against the components of every type and each sparse index against its dense list.
+		/// </summary>
+		/// <param name="in">Binary stream written by snapshot.</param>
+		/// <returns>False if the stream is not a snapshot of this version, is cut short, is inconsistent or holds a
+		/// type that isn't known here. The registry is left as it was then.</returns>
+		bool restore(std::istream& in);
+
+	private:
+		// Storage of existing systems, indexed by system id and in update order.
+		Vector<std::unique_ptr<SystemBase>> systemsByID;
+		Vector<SystemBase*> systems;
+		Vector<std::shared_ptr<GroupHooks>> groups;
+
+		ComponentCounter counter;
+		SignatureIndex signatures;
+
+		// Generation of every id handed out. Ids in the reuse pool also hold the next id in the
+		// pool, so the pool is a free list threaded through this array and never allocates.
+		// Ids outside the pool hold not_pooled instead.
+		struct IDSlot
+		{
+			unsigned int generation;
+			int nextFree;
+		};
+
+		static constexpr int no_free_id = -1;
+		static constexpr int not_pooled = -2;
+
+		// First bytes of every snapshot.
+		static constexpr char snapshot_magic[4] = { 'D', 'E', 'C', 'S' };
+
+		// True if every id handed out has a slot and the free list links each pooled id once and ends.
+		static bool isValidIDPool(int nextID, int firstFree, const Vector<IDSlot>& slots);
+
+		int nextAvailableID = 0;
+		int firstFreeID = no_free_id;
+		Vector<IDSlot> idSlots;
+		std::mutex idMutex;
+
+		// Command buffers of every thread and commands left by buffers that have been destroyed.
+		Vector<CommandBuffer*> commandBuffers;
+		Vector<CommandBuffer::Command> orphanedCommands;
+		Vector<CommandBuffer::Command> appliedCommands;
+		std::mutex commandBufferMutex;
+
+		// Buffers handed out by getCommandBuffer, one per thread that recorded into this registry.
+		Vector<std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>> threadBuffers;
+		std::mutex threadBufferMutex;
+
+		// Tells the buffer a thread remembers apart from one of a registry that used the same address before.
+		std::uint64_t serial;
+
+		float deltaTime = 0;
+
+		// Profiles of recent updates, nullptr unless profiling.
+		std::unique_ptr<Profiler> profiler;
+
+		// Stamped on tracked components when they change. Starts at 1 so a reader that saw nothing yet can pass 0.
+		std::uint32_t changeTick = 1;
+
+		// Parallel update schedule, rebuilt when systems or their access change.
+		std::unique_ptr<ThreadPool> threadPool;
+		bool scheduleChanged = true;
+		Vector<Vector<int>> dependents;
+		Vector<int> dependencyCount;
+		std::unique_ptr<std::atomic<int>[]> remainingDependencies;
+
+		/// <summary>
+		/// Registry bound to the calling thread, nullptr for the default.
+		/// </summary>
+		static Registry*& boundRegistry();
+
+		/// <summary>
+		/// Returns true if system a and system b can't run at the same time.
+		/// </summary>
+		static bool conflicts(SystemBase& a, SystemBase& b);
+
+		/// <summary>
+		/// Builds the dependency graph of systems from their declared access.
+		/// Each system depends on every earlier system in the list it conflicts with.
+		/// </summary>
+		void buildSchedule();
+
+		/// <summary>
+		/// Updates every system on the thread pool following the schedule.
+		/// </summary>
+		void updateScheduled();
+
+		/// <summary>
+		/// Runs update of system at index and queues the systems waiting on it.
+		/// </summary>
+		void runScheduled(int index, std::atomic<int>& unfinished);
+
+		/// <summary>
+		/// Updates the system at index, timing it if profiling.
+		/// </summary>
+		void updateSystem(int index);
+
+		/// <summary>
+		/// Removes or destroys all components of entity. Its id is reused once orphans
+		/// are destroyed, straight away if it had no components. Either way handles to it go stale.
+		/// </summary>
+		void destroyEntityNow(int entityID, bool poolComponents);
+
+		/// <summary>
+		/// Puts id into the pool to be reused, marks it free and bumps its generation.
+		/// </summary>
+		void recycleID(int entityID);
+
+		/// <summary>
+		/// Pops ids off the pool into ids until amount are written or the pool is empty.
+		/// Ids given components directly while they were in the pool are dropped from it.
+		/// </summary>
+		/// <returns>Number of ids written.</returns>
+		int takeFreeIDs(int* ids, int amount);
+
+		/// <summary>
+		/// Hands out the next count never used ids into ids.
+		/// </summary>
+		void takeNewIDs(int* ids, int count);
+
+		/// <summary>
+		/// Used by CommandBuffer on construction and destruction.
+		/// </summary>
+		void registerCommandBuffer(CommandBuffer& buffer);
+		void unregisterCommandBuffer(CommandBuffer& buffer);
+
+		friend class CommandBuffer;
+	};
+
+	inline Registry::Scope::Scope(Registry& registry)
+		: previous(Registry::bind(&registry))
+	{
+
+	}
+
+	inline Registry::Scope::~Scope()
+	{
+		Registry::bind(previous);
+	}
+
+	inline Registry::Registry()
+	{
+		static std::atomic<std::uint64_t> nextSerial(1);
+		serial = nextSerial.fetch_add(1);
+	}
+
+	inline Registry::~Registry()
+	{
+		// Workers can still be recording, stop them before anything they use goes.
+		threadPool.reset();
+		threadBuffers.clear();
+		if (boundRegistry() == this)
+		{
+			boundRegistry() = nullptr;
+		}
+	}
+
+	inline Registry*& Registry::boundRegistry()
+	{
+		thread_local Registry* bound = nullptr;
+		return bound;
+	}
+
+	inline Registry& Registry::getDefault()
+	{
+		static Registry defaultRegistry;
+		return defaultRegistry;
+	}
+
+	inline Registry& Registry::current()
+	{
+		Registry* bound = boundRegistry();
+		return bound != nullptr ? *bound : getDefault();
+	}
+
+	inline Registry* Registry::bind(Registry* registry)
+	{
+		Registry* previous = boundRegistry();
+		boundRegistry() = registry;
+		return previous;
+	}
+
+	inline int Registry::createNewSystemID()
+	{
+		static std::atomic<int> assignableSystemID(0);
+		return assignableSystemID.fetch_add(1);
+	}
+
+	inline int Registry::createNewGroupID()
+	{
+		static std::atomic<int> assignableGroupID(0);
+		return assignableGroupID.fetch_add(1);
+	}
+
+	template<class T>
+	inline SystemState<T>& Registry::getSystemState()
+	{
+		int systemID = System<T>::staticSystemID();
+		if (systemID >= static_cast<int>(systemsByID.size()))
+		{
+			systemsByID.resize(systemID + 1);
+		}
+		if (systemsByID[systemID] == nullptr)
+		{
+			systemsByID[systemID].reset(new SystemState<T>(*this, counter, signatures, changeTick));
+			systems.push_back(systemsByID[systemID].get());
+			scheduleChanged = true;
+		}
+		return static_cast<SystemState<T>&>(*systemsByID[systemID]);
+	}
+
+	template<class T>
+	inline SparseSet<T>& Registry::getSparseSet()
+	{
+		return getSystemState<T>().getSparseSet();
+	}
+
+	template<class... Owned>
+	inline GroupState<Owned...>& Registry::getGroupState()
+	{
+		int groupID = GroupState<Owned...>::groupID();
+		if (groupID >= static_cast<int>(groups.size()))
+		{
+			groups.resize(groupID + 1);
+		}
+		if (groups[groupID] == nullptr)
+		{
+			groups[groupID] = std::make_shared<GroupState<Owned...>>(*this);
+		}
+		return static_cast<GroupState<Owned...>&>(*groups[groupID]);
+	}
+
+	inline void Registry::setDeltaTime(float dt)
+	{
+		deltaTime = dt;
+	}
+
+	inline float Registry::getDeltaTime()
+	{
+		return deltaTime;
+	}
+
+	inline int Registry::createNewID()
+	{
+		// Only lock when systems can be updating on other threads.
+		std::unique_lock<std::mutex> lock(idMutex, std::defer_lock);
+		if (threadPool != nullptr)
+		{
+			lock.lock();
+		}
+		int entityID;
+		if (takeFreeIDs(&entityID, 1) == 0)
+		{
+			takeNewIDs(&entityID, 1);
+		}
+		return entityID;
+	}
+
+	inline Vector<int> Registry::createNewIDs(int amount)
+	{
+		Vector<int> ids;
+		if (amount <= 0)
+		{
+			return ids;
+		}
+		ids.resize(amount);
+		createNewIDs(ids.data(), amount);
+		return ids;
+	}
+
+	inline void Registry::createNewIDs(int* ids, int amount)
+	{
+		if (amount <= 0)
+		{
+			return;
+		}
+		std::unique_lock<std::mutex> lock(idMutex, std::defer_lock);
+		if (threadPool != nullptr)
+		{
+			lock.lock();
+		}
+		int reused = takeFreeIDs(ids, amount);
+		takeNewIDs(ids + reused, amount - reused);
+	}
+
+	inline int Registry::takeFreeIDs(int* ids, int amount)
+	{
+		int taken = 0;
+		while (taken < amount && firstFreeID != no_free_id)
+		{
+			int returnedID = firstFreeID;
+			firstFreeID = idSlots[returnedID].nextFree;
+			idSlots[returnedID].nextFree = not_pooled;
+			// Skip ids given components directly while they were in the pool.
+			if (counter.take(returnedID))
+			{
+				ids[taken++] = returnedID;
+			}
+		}
+		return taken;
+	}
+
+	inline void Registry::takeNewIDs(int* ids, int count)
+	{
+		if (count <= 0)
+		{
+			return;
+		}
+		if (static_cast<size_t>(nextAvailableID + count) > idSlots.size())
+		{
+			idSlots.resize(nextAvailableID + count, IDSlot{ 0, not_pooled });
+		}
+		for (int i = 0; i < count; i++)
+		{
+			ids[i] = nextAvailableID++;
+		}
+	}
+
+	inline Entity Registry::createEntity()
+	{
+		int entityID = createNewID();
+		return getEntity(entityID);
+	}
+
+	inline Entity Registry::getEntity(int entityID)
+	{
+		Entity entity;
+		entity.id = entityID;
+		// Ids that were never handed out or reused are still on generation 0.
+		entity.generation = static_cast<size_t>(entityID) < idSlots.size() ? idSlots[entityID].generation : 0;
+		return entity;
+	}
+
+	inline bool Registry::isAlive(Entity entity)
+	{
+		if (static_cast<size_t>(entity.id) < idSlots.size())
+		{
+			return idSlots[entity.id].generation == entity.generation;
+		}
+		return entity.id >= 0 && entity.generation == 0;
+	}
+
+	inline void Registry::recycleID(int entityID)
+	{
+		if (static_cast<size_t>(entityID) >= idSlots.size())
+		{
+			idSlots.resize(entityID + 1, IDSlot{ 0, not_pooled });
+		}
+		IDSlot& slot = idSlots[entityID];
+		++slot.generation;
+		// Ids given components while in the pool and then orphaned are still linked, linking
+		// them again would make the free list loop.
+		if (slot.nextFree == not_pooled)
+		{
+			slot.nextFree = firstFreeID;
+			firstFreeID = entityID;
+		}
+		counter.setFree(entityID);
+	}
+
+	inline void Registry::update()
+	{
+		Scope scope(*this);
+		advanceChangeTick();
+		int size = static_cast<int>(systems.size());
+		if (profiler != nullptr)
+		{
+			profiler->beginFrame(size, counter.changeCount());
+		}
+
+		if (threadPool == nullptr)
+		{
+			for (int i = 0; i < size; i++)
+			{
+				updateSystem(i);
+			}
+		}
+		else
+		{
+			updateScheduled();
+		}
+
+		// Clean up components marked for destruction.
+		if (profiler == nullptr)
+		{
+			destroyMarked();
+			return;
+		}
+		std::int64_t destroyMarkedStart = profiler->now();
+		destroyMarked();
+		profiler->endFrame(destroyMarkedStart, profiler->now(), counter.changeCount());
+	}
+
+	inline void Registry::updateScheduled()
+	{
+		int size = static_cast<int>(systems.size());
+		if (scheduleChanged)
+		{
+			buildSchedule();
+		}
+
+		std::atomic<int> unfinished(size);
+		for (int i = 0; i < size; i++)
+		{
+			remainingDependencies[i].store(dependencyCount[i]);
+		}
+		for (int i = 0; i < size; i++)
+		{
+			if (dependencyCount[i] == 0)
+			{
+				threadPool->submit([this, i, &unfinished] { runScheduled(i, unfinished); });
+			}
+		}
+		threadPool->waitFor(unfinished);
+	}
+
+	inline void Registry::setThreadCount(int threadCount)
+	{
+		threadPool.reset();
+		if (threadCount > 1)
+		{
+			threadPool.reset(new ThreadPool(threadCount - 1, [this] { bind(this); }));
+		}
+	}
+
+	inline int Registry::getThreadCount()
+	{
+		if (threadPool == nullptr)
+		{
+			return 1;
+		}
+		return threadPool->threadCount() + 1;
+	}
+
+	inline ThreadPool* Registry::getThreadPool()
+	{
+		return threadPool.get();
+	}
+
+	inline void Registry::setProfiling(bool enabled, int frameCapacity)
+	{
+		profiler.reset();
+		if (enabled)
+		{
+			profiler.reset(new Profiler(frameCapacity));
+		}
+	}
+
+	inline Profiler* Registry::getProfiler()
+	{
+		return profiler.get();
+	}
+
+	inline std::uint32_t Registry::getChangeTick()
+	{
+		return changeTick;
+	}
+
+	inline std::uint32_t Registry::advanceChangeTick()
+	{
+		return changeTick++;
+	}
+
+	inline void Registry::accessChanged()
+	{
+		scheduleChanged = true;
+	}
+
+	inline bool Registry::conflicts(SystemBase& a, SystemBase& b)
+	{
+		if (!a.hasDeclaredAccess() || !b.hasDeclaredAccess())
+		{
+			return true;
+		}
+
+		const std::vector<int>& readA = a.getReadAccess();
+		const std::vector<int>& writeA = a.getWriteAccess();
+		const std::vector<int>& readB = b.getReadAccess();
+		const std::vector<int>& writeB = b.getWriteAccess();
+
+		for (int written : writeA)
+		{
+			if (std::find(writeB.begin(), writeB.end(), written) != writeB.end() ||
+				std::find(readB.begin(), readB.end(), written) != readB.end())
+			{
+				return true;
+			}
+		}
+		for (int written : writeB)
+		{
+			if (std::find(readA.begin(), readA.end(), written) != readA.end())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline void Registry::buildSchedule()
+	{
+		int size = static_cast<int>(systems.size());
+		dependents.assign(size, Vector<int>());
+		dependencyCount.assign(size, 0);
+		remainingDependencies.reset(new std::atomic<int>[size]);
+
+		for (int i = 0; i < size; i++)
+		{
+			for (int earlier = 0; earlier < i; earlier++)
+			{
+				if (conflicts(*systems[i], *systems[earlier]))
+				{
+					dependents[earlier].push_back(i);
+					++dependencyCount[i];
+				}
+			}
+		}
+		scheduleChanged = false;
+	}
+
+	inline void Registry::runScheduled(int index, std::atomic<int>& unfinished)
+	{
+		updateSystem(index);
+
+		for (int dependent : dependents[index])
+		{
+			if (remainingDependencies[dependent].fetch_sub(1) == 1)
+			{
+				threadPool->submit([this, dependent, &unfinished] { runScheduled(dependent, unfinished); });
+			}
+		}
+		unfinished.fetch_sub(1);
+	}
+
+	inline void Registry::updateSystem(int index)
+	{
+		SystemBase& system = *systems[index];
+		if (profiler == nullptr)
+		{
+			system.update();
+			return;
+		}
+		int componentCount = system.getNumberOfActiveComponents();
+		std::int64_t start = profiler->now();
+		system.update();
+		profiler->recordSystem(index, system.getSystemID(), system.getName(), componentCount, start, profiler->now());
+	}
+
+	inline CommandBuffer& Registry::getCommandBuffer()
+	{
+		// The buffer used last on this thread is remembered so recording takes no lock.
+		thread_local std::uint64_t cachedSerial = 0;
+		thread_local CommandBuffer* cachedBuffer = nullptr;
+		if (cachedSerial == serial)
+		{
+			return *cachedBuffer;
+		}
+
+		std::lock_guard<std::mutex> lock(threadBufferMutex);
+		std::thread::id self = std::this_thread::get_id();
+		CommandBuffer* buffer = nullptr;
+		for (std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>& threadBuffer : threadBuffers)
+		{
+			if (threadBuffer.first == self)
+			{
+				buffer = threadBuffer.second.get();
+				break;
+			}
+		}
+		if (buffer == nullptr)
+		{
+			// A thread started later with the same id takes over the buffer, which is never in use by two threads.
+			threadBuffers.emplace_back(self, std::unique_ptr<CommandBuffer>(new CommandBuffer(*this)));
+			buffer = threadBuffers.back().second.get();
+		}
+		cachedSerial = serial;
+		cachedBuffer = buffer;
+		return *buffer;
+	}
+
+	inline void Registry::registerCommandBuffer(CommandBuffer& buffer)
+	{
+		std::lock_guard<std::mutex> lock(commandBufferMutex);
+		commandBuffers.push_back(&buffer);
+	}
+
+	inline void Registry::unregisterCommandBuffer(CommandBuffer& buffer)
+	{
+		std::lock_guard<std::mutex> lock(commandBufferMutex);
+		Vector<CommandBuffer::Command>& commands = buffer.getCommands();
+		orphanedCommands.insert(orphanedCommands.end(), commands.begin(), commands.end());
+		commandBuffers.erase(std::remove(commandBuffers.begin(), commandBuffers.end(), &buffer), commandBuffers.end());
+	}
+
+	inline void Registry::destroyEntity(int entityID, bool poolComponents)
+	{
+		getCommandBuffer().destroyEntity(entityID, poolComponents);
+	}
+
+	inline void Registry::destroyEntity(Entity entity, bool poolComponents)
+	{
+		if (isAlive(entity))
+		{
+			getCommandBuffer().destroyEntity(entity.id, poolComponents);
+		}
+	}
+
+	inline void Registry::destroyEntityNow(int entityID, bool poolComponents)
+	{
+		// Free ids are already in the pool, which also covers an entity destroyed more than once.
+		int componentCount = counter.count(entityID);
+		if (componentCount == ComponentCounter::free_id)
+		{
+			return;
+		}
+
+		// Nothing to remove, release the id now. Ids never handed out can't be pooled
+		// or takeNewIDs would hand them out a second time.
+		if (componentCount == 0)
+		{
+			if (entityID >= 0 && entityID < nextAvailableID)
+			{
+				recycleID(entityID);
+			}
+			return;
+		}
+
+		// Only visit the systems the signature says hold a component of the entity.
+		signatures.forEachType(entityID, [this, entityID, poolComponents](int systemID)
+		{
+			SystemBase* system = systemsByID[systemID].get();
+			if (poolComponents)
+			{
+				system->removeAllComponentsWithID(entityID);
+			}
+			else
+			{
+				system->destroyAllComponentsWithID(entityID);
+			}
+		});
+	}
+
+	inline void Registry::reset()
+	{
+		for (SystemBase* system : systems)
+		{
+			system->reset();
+		}
+		{
+			std::lock_guard<std::mutex> lock(commandBufferMutex);
+			orphanedCommands = Vector<CommandBuffer::Command>();
+			for (CommandBuffer* buffer : commandBuffers)
+			{
+				buffer->getCommands().clear();
+			}
+		}
+		nextAvailableID = 0;
+		firstFreeID = no_free_id;
+		idSlots = Vector<IDSlot>();
+		counter = ComponentCounter();
+		signatures = SignatureIndex();
+	}
+
+	inline void Registry::destroyAllEntities(bool poolComponents)
+	{
+		int systemSize = static_cast<int>(systems.size());
+		int highestID = 0;
+
+		for (int i = 0; i < systemSize; i++)
+		{
+			int highestSystemID = systems[i]->highestIDUsed();
+			if (highestSystemID > highestID)
+			{
+				highestID = highestSystemID;
+			}
+		}
+
+		for (int j = 0; j <= highestID; j++)
+		{
+			destroyEntity(j, poolComponents);
+		}
+	}
+
+	inline void Registry::destroyOrphanedEntities()
+	{
+		Vector<int>& orphans = counter.orphans();
+
+		for (int orphan : orphans)
+		{
+			// Orphans can regain components or be queued more than once before this runs.
+			if (counter.count(orphan) == 0)
+			{
+				recycleID(orphan);
+			}
+		}
+		orphans.clear();
+	} // End destroyOrphanedentitiies();
+
+	inline void Registry::destroyMarked()
+	{
+		// Components initialised while applying commands can call World.
+		Scope scope(*this);
+
+		// Gather the commands of every thread. Commands recorded while applying
+		// these go into emptied buffers and are applied next time.
+		Vector<CommandBuffer::Command> batch;
+		batch.swap(appliedCommands);
+		{
+			std::lock_guard<std::mutex> lock(commandBufferMutex);
+			batch.insert(batch.end(), orphanedCommands.begin(), orphanedCommands.end());
+			orphanedCommands.clear();
+			for (CommandBuffer* buffer : commandBuffers)
+			{
+				Vector<CommandBuffer::Command>& commands = buffer->getCommands();
+				batch.insert(batch.end(), commands.begin(), commands.end());
+				commands.clear();
+			}
+		}
+
+		// Sorting makes the result independent of which thread recorded a command.
+		// Commands that compare equal are identical, so std::sort gives the same order as
+		// std::stable_sort without allocating a temporary buffer.
+		std::sort(batch.begin(), batch.end(),
+			[](const CommandBuffer::Command& a, const CommandBuffer::Command& b)
+		{
+			if (a.entityID != b.entityID)
+			{
+				return a.entityID < b.entityID;
+			}
+			if (a.type != b.type)
+			{
+				return a.type < b.type;
+			}
+			return a.systemID < b.systemID;
+		});
+
+		size_t size = batch.size();
+		size_t first = 0;
+		while (first < size)
+		{
+			int entityID = batch[first].entityID;
+			size_t last = first + 1;
+			while (last < size && batch[last].entityID == entityID)
+			{
+				++last;
+			}
+
+			// Destroys sort last, a destroy that doesn't pool sorts after one that does.
+			CommandBuffer::CommandType lastType = batch[last - 1].type;
+			if (lastType == CommandBuffer::CommandType::DestroyEntity ||
+				lastType == CommandBuffer::CommandType::DestroyPooledEntity)
+			{
+				destroyEntityNow(entityID, lastType == CommandBuffer::CommandType::DestroyPooledEntity);
+			}
+			else
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					int systemID = batch[i].systemID;
+					if (systemID >= static_cast<int>(systemsByID.size()) || systemsByID[systemID] == nullptr)
+					{
+						continue;
+					}
+					if (batch[i].type == CommandBuffer::CommandType::AddComponent)
+					{
+						systemsByID[systemID]->addComponentWithID(entityID);
+					}
+					else
+					{
+						systemsByID[systemID]->removeComponentWithID(entityID);
+					}
+				}
+			}
+			first = last;
+		}
+
+		// Keep the allocation for next time.
+		batch.clear();
+		batch.swap(appliedCommands);
+
+		// Destroyed entities and any others left without components.
+		destroyOrphanedEntities();
+	} // end Destroy();
+
+	inline int Registry::getNextAvailableEntityID()
+	{
+		return nextAvailableID;
+	}
+
+	inline bool Registry::matches(int entityID, const Signature& include, const Signature& exclude)
+	{
+		return signatures.matches(entityID, include, exclude);
+	}
+
+	inline void Registry::query(const Signature& include, const Signature& exclude, std::vector<int>& ids)
+	{
+		signatures.query(include, exclude, ids);
+	}
+
+	inline bool Registry::snapshot(std::ostream& out)
+	{
+		for (SystemBase* system : systems)
+		{
+			if (!system->canSnapshot())
+			{
+				return false;
+			}
+		}
+
+		out.write(snapshot_magic, sizeof(snapshot_magic));
+		writeValue(out, snapshot_version);
+		writeValue(out, nextAvailableID);
+		writeValue(out, firstFreeID);
+		writeList(out, idSlots);
+		counter.write(out);
+		writeValue(out, changeTick);
+
+		// Types are named rather than numbered, system ids depend on the order types were first used in.
+		writeValue(out, static_cast<std::uint32_t>(systems.size()));
+		for (SystemBase* system : systems)
+		{
+			const char* name = system->getName();
+			std::uint32_t length = static_cast<std::uint32_t>(std::strlen(name));
+			writeValue(out, length);
+			out.write(name, length);
+			system->writeSnapshot(out);
+		}
+		return out.good();
+	}
+
+	inline bool Registry::isValidIDPool(int nextID, int firstFree, const Vector<IDSlot>& slots)
+	{
+		if (nextID < 0 || static_cast<size_t>(nextID) > slots.size())
+		{
+			return false;
+		}
+
+		// Ids in the pool link the next one or no_free_id, every other id holds not_pooled.
+		size_t pooled = 0;
+		for (const IDSlot& slot : slots)
+		{
+			if (slot.nextFree != not_pooled)
+			{
+				if (slot.nextFree != no_free_id && (slot.nextFree < 0 || static_cast<size_t>(slot.nextFree) >= slots.size()))
+				{
+					return false;
+				}
+				++pooled;
+			}
+		}
+
+		// A walk longer than the pooled ids loops, a shorter one misses some.
+		size_t walked = 0;
+		for (int id = firstFree; id != no_free_id; id = slots[id].nextFree)
+		{
+			if (id < 0 || static_cast<size_t>(id) >= slots.size() || slots[id].nextFree == not_pooled || ++walked > pooled)
+			{
+				return false;
+			}
+		}
+		return walked == pooled;
+	}
+
+	inline bool Registry::restore(std::istream& in)
+	{
+		char magic[sizeof(snapshot_magic)];
+		std::uint32_t version;
+		in.read(magic, sizeof(magic));
+		if (in.fail() || std::memcmp(magic, snapshot_magic, sizeof(magic)) != 0 || !readValue(in, version) || version != snapshot_version)
+		{
+			return false;
+		}
+
+		// Everything is read into these and the staged sets first, so a bad snapshot leaves the registry as it was.
+		int readNextID;
+		int readFirstFree;
+		Vector<IDSlot> readSlots;
+		ComponentCounter readCounter;
+		std::uint32_t readTick;
+		std::uint32_t systemCount = 0;
+		bool restored = readValue(in, readNextID) && readValue(in, readFirstFree) && readList(in, readSlots)
+			&& isValidIDPool(readNextID, readFirstFree, readSlots) && readCounter.read(in) && readValue(in, readTick)
+			&& readValue(in, systemCount);
+
+		Vector<int> tally(restored ? readCounter.idCount() : 0, 0);
+		Vector<SystemBase*> read;
+		std::string name;
+		for (std::uint32_t i = 0; restored && i < systemCount; i++)
+		{
+			std::uint32_t length;
+			restored = readValue(in, length) && length <= 4096;
+			if (restored)
+			{
+				name.resize(length);
+				in.read(&name[0], length);
+				restored = !in.fail();
+			}
+
+			SystemBase* found = nullptr;
+			for (SystemBase* system : systems)
+			{
+				if (restored && name == system->getName())
+				{
+					found = system;
+					break;
+				}
+			}
+			restored = found != nullptr && std::find(read.begin(), read.end(), found) == read.end() && found->stageSnapshot(in, tally);
+			if (restored)
+			{
+				read.push_back(found);
+			}
+		}
+
+		if (!restored || !readCounter.matches(tally))
+		{
+			for (SystemBase* system : read)
+			{
+				system->discardSnapshot();
+			}
+			return false;
+		}
+
+		for (SystemBase* system : systems)
+		{
+			system->clear();
+		}
+		{
+			std::lock_guard<std::mutex> lock(commandBufferMutex);
+			orphanedCommands.clear();
+			for (CommandBuffer* buffer : commandBuffers)
+			{
+				buffer->getCommands().clear();
+			}
+		}
+		nextAvailableID = readNextID;
+		firstFreeID = readFirstFree;
+		idSlots = std::move(readSlots);
+		counter = std::move(readCounter);
+		changeTick = readTick;
+
+		// Each set sets the signature bits of its own ids again.
+		signatures = SignatureIndex();
+		signatures.reserve(static_cast<int>(std::max(idSlots.size(), tally.size())), static_cast<int>(systemsByID.size()));
+		for (SystemBase* system : read)
+		{
+			system->applySnapshot();
+		}
+
+		// Sets come back in the order they were written, which was packed for the groups of the other registry.
+		for (std::shared_ptr<GroupHooks>& group : groups)
+		{
+			group->restored(*group);
+		}
+		return true;
+	}
+
+	inline CommandBuffer::CommandBuffer()
+		: CommandBuffer(Registry::current())
+	{
+
+	}
+
+	inline CommandBuffer::CommandBuffer(Registry& registry)
+		: registry(registry)
+	{
+		registry.registerCommandBuffer(*this);
+	}
+
+	inline CommandBuffer::~CommandBuffer()
+	{
+		registry.unregisterCommandBuffer(*this);
+	}
+
+	inline int CommandBuffer::createEntity()
+	{
+		return registry.createNewID();
+	}
+} // End Registry
+
+namespace decs
+{
+	/// <summary>
+	/// Static access to the Registry bound to the calling thread, the default registry unless
+	/// Registry::bind or a Registry::Scope says otherwise. Programs with one world can use World
+	/// and never create a Registry. See Registry for what each call does.
+	/// </summary>
+	class World
+	{
+	public:
+		/// <summary>
+		/// Returns the registry bound to the calling thread.
+		/// </summary>
+		static Registry& getRegistry();
+
+		/// <summary>
+		/// Set new delta time. Do this at the begininng of every frame to make sure your programs are frame rate
+		/// independant;
+		/// </summary>
+		/// <param name="dt">delta time float to be passed</param>
+		static void setDeltaTime(float dt);
+
+		/// <summary>
+		/// Get delta time of current frame
+		/// </summary>
+		static float getDeltaTime();
+
+		/// <summary>
+		/// Returns ID to be used. See Registry::createNewID.
+		/// </summary>
+		static int createNewID();
+
+		/// <summary>
+		/// Returns amount ids for use. See Registry::createNewIDs.
+		/// </summary>
+		static Vector<int> createNewIDs(int amount);
+
+		/// <summary>
+		/// Writes amount ids for use to ids without allocating. See Registry::createNewIDs.
+		/// </summary>
+		static void createNewIDs(int* ids, int amount);
+
+		/// <summary>
+		/// Returns a handle to a new entity.
+		/// </summary>
+		static Entity createEntity();
+
+		/// <summary>
+		/// Returns the handle of the entity currently using id.
+		/// </summary>
+		static Entity getEntity(int entityID);
+
+		/// <summary>
+		/// Returns false once the entity has been destroyed. See Registry::isAlive.
+		/// </summary>
+		static bool isAlive(Entity entity);
+
+		/// <summary>
+		/// Returns a new component type id, the same in every registry.
+		/// </summary>
+		static int createNewSystemID();
+
+		/// <summary>
+		/// Calls update on all systems. See Registry::update.
+		/// </summary>
+		static void update();
+
+		/// <summary>
+		/// Sets the number of threads used by update, including the calling thread.
+		/// </summary>
+		static void setThreadCount(int threadCount);
+
+		/// <summary>
+		/// Returns the number of threads used by update, including the calling thread.
+		/// </summary>
+		static int getThreadCount();
+
+		/// <summary>
+		/// Returns the pool used by update or nullptr if update runs on one thread.
+		/// </summary>
+		static ThreadPool* getThreadPool();
+
+		/// <summary>
+		/// Turns profiling of update on or off. See Registry::setProfiling.
+		/// </summary>
+		static void setProfiling(bool enabled, int frameCapacity = 256);
+
+		/// <summary>
+		/// Returns the profiler recording updates or nullptr if profiling is off.
+		/// </summary>
+		static Profiler* getProfiler();
+
+		/// <summary>
+		/// Returns the tick changes to tracked components are stamped with.
+		/// </summary>
+		static std::uint32_t getChangeTick();
+
+		/// <summary>
+		/// Starts a new change tick and returns the one that ended. See Registry::advanceChangeTick.
+		/// </summary>
+		static std::uint32_t advanceChangeTick();
+
+		/// <summary>
+		/// Tells the registry the update schedule needs rebuilding.
+		/// </summary>
+		static void accessChanged();
+
+		/// <summary>
+		/// Returns the command buffer of the calling thread.
+		/// </summary>
+		static CommandBuffer& getCommandBuffer();
+
+		/// <summary>
+		/// Marks entity to be destroyed at the end of the update cycle.
+		/// </summary>
+		static void destroyEntity(int entityID, bool poolComponents = true);
+
+		/// <summary>
+		/// Marks entity to be destroyed. Does nothing if the handle is stale.
+		/// </summary>
+		static void destroyEntity(Entity entity, bool poolComponents = true);
+
+		/// <summary>
+		/// Marks all ids and components for destruction.
+		/// </summary>
+		static void destroyAllEntities(bool poolComponents = false);
+
+		/// <summary>
+		/// Places ids whose last component was removed into the id pool to be reused.
+		/// </summary>
+		static void destroyOrphanedEntities();
+
+		/// <summary>
+		/// Destroys marked components and applies every other recorded command.
+		/// </summary>
+		static void destroyMarked();
+
+		/// <summary>
+		/// Returns what the next availble id will be but doesn't increment.
+		/// </summary>
+		static int getNextAvailableEntityID();
+
+		/// <summary>
+		/// Returns true if entity has every component type in include and none in exclude.
+		/// </summary>
+		static bool matches(int entityID, const Signature& include, const Signature& exclude = Signature());
+
+		/// <summary>
+		/// Fills ids with every entity that has all component types in include and none in exclude.
+		/// </summary>
+		static void query(const Signature& include, const Signature& exclude, std::vector<int>& ids);
+
+		/// <summary>
+		/// Writes the registry to a binary stream. See Registry::snapshot.
+		/// </summary>
+		static bool snapshot(std::ostream& out);
+
+		/// <summary>
+		/// Replaces the registry with a snapshot. See Registry::restore.
+		/// </summary>
+		static bool restore(std::istream& in);
+	};
+
+	inline Registry& World::getRegistry()
+	{
+		return Registry::current();
+	}
+
+	inline void World::setDeltaTime(float dt)
+	{
+		Registry::current().setDeltaTime(dt);
+	}
+
+	inline float World::getDeltaTime()
+	{
+		return Registry::current().getDeltaTime();
+	}
+
+	inline int World::createNewID()
+	{
+		return Registry::current().createNewID();
+	}
+
+	inline Vector<int> World::createNewIDs(int amount)
+	{
+		return Registry::current().createNewIDs(amount);
+	}
+
+	inline void World::createNewIDs(int* ids, int amount)
+	{
+		Registry::current().createNewIDs(ids, amount);
+	}
+
+	inline Entity World::createEntity()
+	{
+		return Registry::current().createEntity();
+	}
+
+	inline Entity World::getEntity(int entityID)
+	{
+		return Registry::current().getEntity(entityID);
+	}
+
+	inline bool World::isAlive(Entity entity)
+	{
+		return Registry::current().isAlive(entity);
+	}
+
+	inline int World::createNewSystemID()
+	{
+		return Registry::createNewSystemID();
+	}
+
+	inline void World::update()
+	{
+		Registry::current().update();
+	}
+
+	inline void World::setThreadCount(int threadCount)
+	{
+		Registry::current().setThreadCount(threadCount);
+	}
+
+	inline int World::getThreadCount()
+	{
+		return Registry::current().getThreadCount();
+	}
+
+	inline ThreadPool* World::getThreadPool()
+	{
+		return Registry::current().getThreadPool();
+	}
+
+	inline void World::setProfiling(bool enabled, int frameCapacity)
+	{
+		Registry::current().setProfiling(enabled, frameCapacity);
+	}
+
+	inline Profiler* World::getProfiler()
+	{
+		return Registry::current().getProfiler();
+	}
+
+	inline std::uint32_t World::getChangeTick()
+	{
+		return Registry::current().getChangeTick();
+	}
+
+	inline std::uint32_t World::advanceChangeTick()
+	{
+		return Registry::current().advanceChangeTick();
+	}
+
+	inline void World::accessChanged()
+	{
+		Registry::current().accessChanged();
+	}
+
+	inline CommandBuffer& World::getCommandBuffer()
+	{
+		return Registry::current().getCommandBuffer();
+	}
+
+	inline void World::destroyEntity(int entityID, bool poolComponents)
+	{
+		Registry::current().destroyEntity(entityID, poolComponents);
+	}
+
+	inline void World::destroyEntity(Entity entity, bool poolComponents)
+	{
+		Registry::current().destroyEntity(entity, poolComponents);
+	}
+
+	inline void World::destroyAllEntities(bool poolComponents)
+	{
+		Registry::current().destroyAllEntities(poolComponents);
+	}
+
+	inline void World::destroyOrphanedEntities()
+	{
+		Registry::current().destroyOrphanedEntities();
+	}
+
+	inline void World::destroyMarked()
+	{
+		Registry::current().destroyMarked();
+	}
+
+	inline int World::getNextAvailableEntityID()
+	{
+		return Registry::current().getNextAvailableEntityID();
+	}
+
+	inline bool World::matches(int entityID, const Signature& include, const Signature& exclude)
+	{
+		return Registry::current().matches(entityID, include, exclude);
+	}
+
+	inline void World::query(const Signature& include, const Signature& exclude, std::vector<int>& ids)
+	{
+		Registry::current().query(include, exclude, ids);
+	}
+
+	inline bool World::snapshot(std::ostream& out)
+	{
+		return Registry::current().snapshot(out);
+	}
+
+	inline bool World::restore(std::istream& in)
+	{
+		return Registry::current().restore(in);
+	}
+} // End World class
+
 namespace decs
 {
-	class Component;
 	/// <summary>
-	///	SparseSet is a modified class based on Sam Griffiths class 
-	/// template of a sparse set of integers. The original
-	/// can be found here: https://gist.github.com/sjgriffiths/06732c6076b9db8a7cf4dfe3a7aed43a
+	/// Components and update settings of T in one Registry. The registry creates it the first time
+	/// T is used and every System<T> made for that registry works on it.
+	/// </summary>
+	/// <typeparam name="T">Class/Struct that inherits from decs::Component or decs::PodComponent<T>.</typeparam>
+	template<class T>
+	class SystemState : public SystemBase
+	{
+	public:
+		SystemState(Registry& registry, ComponentCounter& counter, SignatureIndex& signatures, const std::uint32_t& changeTick);
+
+		/// <summary>
+		/// Returns the components of T.
+		/// </summary>
+		SparseSet<T>& getSparseSet();
+
+		bool removeAllComponentsWithID(int entityId) override;
+		bool destroyAllComponentsWithID(int entityId) override;
+		bool hasComponentWithID(int entityID) override;
+		void addComponentWithID(int entityId) override;
+		void removeComponentWithID(int entityId) override;
+		int getSystemID() override;
+		const char* getName() override;
+		void update() override;
+		int highestIDUsed() override;
+		int getNumberOfActiveComponents() override;
+		void clear() override;
+		void reset() override;
+		bool hasDeclaredAccess() override;
+		const std::vector<int>& getReadAccess() override;
+		const std::vector<int>& getWriteAccess() override;
+		bool canSnapshot() override;
+		void writeSnapshot(std::ostream& out) override;
+		bool stageSnapshot(std::istream& in, Vector<int>& tally) override;
+		void applySnapshot() override;
+		void discardSnapshot() override;
+
+	private:
+		Registry& registry;
+		SparseSet<T> entityManager;
+
+		bool allowUpdate = true;
+		bool allowParallelUpdate = false;
+		int minimumChunkSize = 1024;
+
+		bool accessDeclared = false;
+		std::vector<int> readAccess;
+		std::vector<int> writeAccess;
+
+		/// <summary>
+		/// Adds system id to access if not already in it.
+		/// </summary>
+		static void declareAccess(std::vector<int>& access, int id);
+
+		friend class System<T>;
+	};
+
+	template<class T>
+	inline SystemState<T>::SystemState(Registry& registry, ComponentCounter& counter, SignatureIndex& signatures, const std::uint32_t& changeTick)
+		: registry(registry), entityManager(counter, signatures, changeTick)
+	{
+
+	}
+
+	template<class T>
+	inline SparseSet<T>& SystemState<T>::getSparseSet()
+	{
+		return entityManager;
+	}
+
+	template<class T>
+	bool SystemState<T>::removeAllComponentsWithID(int entityId)
+	{
+		return entityManager.removeAllWithID(entityId);
+	}
+
+	template<class T>
+	bool SystemState<T>::destroyAllComponentsWithID(int entityId)
+	{
+		return entityManager.eraseAllWithID(entityId);
+	}
+
+	template<class T>
+	bool SystemState<T>::hasComponentWithID(int entityID)
+	{
+		return entityManager.has(entityID);
+	}
+
+	template<class T>
+	void SystemState<T>::addComponentWithID(int entityId)
+	{
+		entityManager.insert(entityId);
+	}
+
+	template<class T>
+	void SystemState<T>::removeComponentWithID(int entityId)
+	{
+		entityManager.removeWithID(entityId);
+	}
+
+	template<class T>
+	int SystemState<T>::getSystemID()
+	{
+		return System<T>::staticSystemID();
+	}
+
+	template<class T>
+	const char* SystemState<T>::getName()
+	{
+		if constexpr (HasSnapshotName<T>::value)
+		{
+			return T::snapshotName();
+		}
+		else
+		{
+			return typeid(T).name();
+		}
+	}
+
+	template<class T>
+	void SystemState<T>::update()
+	{
+		if (!allowUpdate)
+		{
+			return;
+		}
+
+		ThreadPool* pool = registry.getThreadPool();
+		int count = entityManager.activeRange();
+		if (!allowParallelUpdate || pool == nullptr || count < minimumChunkSize * 2)
+		{
+			entityManager.runUpdate();
+			return;
+		}
+
+		// Aim for a few chunks per thread so stealing can even out uneven work. The dense list starts on a
+		// cache line, so chunks a whole number of lines long never share a line with their neighbours.
+		const int stride = cacheLineStride(entityManager.getDenseList());
+		int chunkSize = std::max(minimumChunkSize, count / ((pool->threadCount() + 1) * 4));
+		chunkSize = (chunkSize + stride - 1) / stride * stride;
+		pool->parallelFor(0, count, chunkSize, [this](int begin, int end)
+		{
+			entityManager.runUpdate(begin, end);
+		});
+	}
+
+	template<class T>
+	int SystemState<T>::highestIDUsed()
+	{
+		return entityManager.numberOfIDs();
+	}
+
+	template<class T>
+	int SystemState<T>::getNumberOfActiveComponents()
+	{
+		return entityManager.getNumberOfActiveComponents();
+	}
+
+	template<class T>
+	void SystemState<T>::clear()
+	{
+		entityManager.clear();
+	}
+
+	template<class T>
+	void SystemState<T>::reset()
+	{
+		entityManager.reset();
+	}
+
+	template<class T>
+	bool SystemState<T>::hasDeclaredAccess()
+	{
+		return accessDeclared;
+	}
+
+	template<class T>
+	const std::vector<int>& SystemState<T>::getReadAccess()
+	{
+		return readAccess;
+	}
+
+	template<class T>
+	const std::vector<int>& SystemState<T>::getWriteAccess()
+	{
+		return writeAccess;
+	}
+
+	template<class T>
+	bool SystemState<T>::canSnapshot()
+	{
+		return CanSnapshot<T>::value || entityManager.empty();
+	}
+
+	template<class T>
+	void SystemState<T>::writeSnapshot(std::ostream& out)
+	{
+		entityManager.writeSnapshot(out);
+	}
+
+	template<class T>
+	bool SystemState<T>::stageSnapshot(std::istream& in, Vector<int>& tally)
+	{
+		return entityManager.stageSnapshot(in, tally);
+	}
+
+	template<class T>
+	void SystemState<T>::applySnapshot()
+	{
+		entityManager.applySnapshot();
+	}
+
+	template<class T>
+	void SystemState<T>::discardSnapshot()
+	{
+		entityManager.discardSnapshot();
+	}
+
+	template<class T>
+	inline void SystemState<T>::declareAccess(std::vector<int>& access, int id)
+	{
+		if (std::find(access.begin(), access.end(), id) == access.end())
+		{
+			access.push_back(id);
+		}
+	}
+
+	/// <summary>
+	/// System class that inherits struct or class that has inherited from decs::Component or decs::PodComponent<T>.
+	/// This handles all get, find, destroy and remove component logic as well
+	/// as handling the update call.
 	/// 
-	/// Class and Struct Components created must inherit from the Component class to use this.
+	/// A System<T> is a handle to the SystemState<T> of one Registry. Every handle made for the
+	/// same registry works on the same components and settings, so handles can be constructed
+	/// wherever they are needed.
 	/// </summary>
-	/// <typeparam name="T">User defined class/struct that inherits from decs::Component.</typeparam>
-	template <class T>
-	class SparseSet
+	/// <typeparam name="T">Class/Struct that inherits from decs::Component or decs::PodComponent<T>.</typeparam>
+	template<class T>
+	class System
 	{
-		static_assert(std::is_convertible<T*, Component*>::value, "class<T>/struct<T> Must inherit from Component");
+		static_assert(std::is_base_of<ComponentBase, T>::value, "class<T> Must inherit from Component or PodComponent<T>");
+	public:
+		typedef typename SparseSet<T>::storage_type storage_type;
+		typedef typename SparseSet<T>::reference reference;
+		typedef typename SparseSet<T>::pointer pointer;
+		typedef typename SparseSet<T>::read_type read_type;
+
+		/// <summary>
+		/// Handle to the components of T in the registry bound to the calling thread.
+		/// </summary>
+		System();
+
+		/// <summary>
+		/// Handle to the components of T in registry.
+		/// </summary>
+		/// <param name="registry">Registry that owns the components.</param>
+		explicit System(Registry& registry);
+
+		/// <summary>
+		/// Adds default component to id. Sets component to active and then calls 
+		/// initialise.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		void addComponentWithID(int id);
+
+		/// <summary>
+		/// Adds default component to entity. Does nothing if the handle is stale.
+		/// </summary>
+		/// <param name="entity">Handle of the entity.</param>
+		void addComponentWithID(Entity entity);
 
-	private:
-		static int size_dense_vector;
-		static int capacity_sparse_vector;
+		/// <summary>
+		/// Adds default components to every id. Storage is grown once for the batch, then
+		/// each component is set to active and initialised in order.
+		/// </summary>
+		/// <param name="ids">ID tags of components.</param>
+		/// <param name="count">Number of ids.</param>
+		void addComponentsWithIDs(const int* ids, int count);
 
-	protected:
-		static std::vector<T> dense;
-		static std::vector<std::vector<int>> sparse;
+		/// <summary>
+		/// Adds default components to every id. See addComponentsWithIDs(const int*, int).
+		/// </summary>
+		/// <param name="ids">ID tags of components, for example from World::createNewIDs.</param>
+		template<class IDAllocator>
+		void addComponentsWithIDs(const std::vector<int, IDAllocator>& ids);
 
 		/// <summary>
-		/// Method to perform a default insert of a newly constructed component.
+		/// Pushes back component to of id index position.
+		/// Does not initialise or set component to active.
 		/// </summary>
-		/// <param name="id">ID to tag component with.</param>
-		void defaultInsert(int id);
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="copy">Component values to push back.</param>
+		void addComponentValuesWithID(int id, T& copy);
 
 		/// <summary>
-		/// Method to perform a pooled insert.
+		/// Emplaces values of component to back of id indexed position.
+		/// Does not initialise or set component to active.
 		/// </summary>
-		/// <param name="id">ID to tag component with.</param>
-		void pooledInsert(int id);
+		/// <param name="id">ID tag of compponent.</param>
+		/// <param name="emplaced">Component values to emplace back.</param>
+		void emplaceComponentWithID(int id, T&& emplaced);
 
 		/// <summary>
-		/// Remove algorithm that handles organising dense list for pooling and destrtuction.
-		/// Will reorder components if a component is moved closer to the beginning of dense list.
-		/// Best case O(1), worst case O(N) based on complexity of copy constructor.
+		/// Marks component first found in dense list for removal
+		/// into a pool.
 		/// </summary>
-		/// <param name="id">ID of component to perform removal/deletion on.</param>
-		/// <param name="index">Index position of component to perform removal/deletion on.</param>
-		void rem(int id, int index = 0);
+		/// <param name="id">ID tag of component.</param>
+		void removeComponentWithID(int id);
 
-	public:
-		SparseSet();
-		~SparseSet();
+		/// <summary>
+		/// Marks first component of entity for removal into a pool.
+		/// Does nothing if the handle is stale.
+		/// </summary>
+		/// <param name="entity">Handle of the entity.</param>
+		void removeComponentWithID(Entity entity);
 
+		/// <summary>
+		/// Marks components with id tag at given index for removal into
+		/// a pool. Does nothing if indexed position doesn't exist.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">Index position of component.</param>
+		void removeComponentWithIDAtIndex(int id, int index);
 
 		/// <summary>
-		/// Returns begin iterator of dense list.
+		/// Marks all components found with id for removal into a pool.
 		/// </summary>
-		/// <returns>Returns begin iterator of dense list.</returns>
-		typename std::vector<T>::iterator begin();
+		/// <param name="id">ID tag of component.</param>
+		/// <returns>True if components removed, false otherwise.</returns>
+		bool removeAllComponentsWithID(int id);
 
 		/// <summary>
-		/// Retruns last element iterator of dense list.
+		/// Removes all components of every id into a pool.
 		/// </summary>
-		/// <returns>Retruns last element iterator of dense list.</returns>
-		typename std::vector<T>::iterator back();
+		/// <param name="ids">ID tags of components.</param>
+		/// <param name="count">Number of ids.</param>
+		/// <returns>Number of components removed.</returns>
+		int removeAllComponentsWithIDs(const int* ids, int count);
 
 		/// <summary>
-		/// Iterator end of dense list.
+		/// Removes all components of every id into a pool.
 		/// </summary>
-		/// <returns>End iterator of dense list.</returns>
-		typename std::vector<T>::iterator end();
+		/// <param name="ids">ID tags of components.</param>
+		/// <returns>Number of components removed.</returns>
+		template<class IDAllocator>
+		int removeAllComponentsWithIDs(const std::vector<int, IDAllocator>& ids);
 
 		/// <summary>
-		/// Returns size of used components in dense list.
+		/// Marks component with given id at first indexed position
+		/// for destruction. Components are removed at the end of a update cycle.
 		/// </summary>
-		/// <returns>Returns size of used components in dense list.</returns>
-		int size();
+		/// <param name="id">ID tag of component.</param>
+		void destroyComponentWithID(int id);
 
 		/// <summary>
-		/// Returns the amount of IDs in use. Highest id that can be used would be numberOfIDs - 1.
+		/// Marks first component of entity for destruction.
+		/// Does nothing if the handle is stale.
 		/// </summary>
-		/// <returns>Returns the amount of IDs in use.</returns>
-		int numberOfIDs();
+		/// <param name="entity">Handle of the entity.</param>
+		void destroyComponentWithID(Entity entity);
 
 		/// <summary>
-		/// Returns size of dense list both active and inactive.
+		/// Marks component with given id at index position
+		/// for destruction. Components are removed at the end of a update cycle.
 		/// </summary>
-		/// <returns>Returns size of dense list both active and inactive.</returns>
-		int denseListSize();
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">indexed position of component.</param>
+		void destroyComponentWithIDAtIndex(int id, int index);
 
 		/// <summary>
-		/// Cheks if dense list is currently empty.
+		/// Marks all components with given id at index position
+		/// for destruction. Components are removed at the end of a update cycle.
 		/// </summary>
-		/// <returns>True if dense list contains no active objects, otherwise returns false if contains objects.</returns>
-		bool empty();
+		/// <param name="id">ID tag of component.</param>
+		/// <returns>True if components destroyed, false otherwise.</returns>
+		bool destroyAllComponentsWithID(int id);
 
 		/// <summary>
-		/// Clears dense list, sparse list and resizes everything back to 0.
+		/// Destroys all components of every id. The dense list is shrunk once at the end.
+		/// </summary>
+		/// <param name="ids">ID tags of components.</param>
+		/// <param name="count">Number of ids.</param>
+		/// <returns>Number of components destroyed.</returns>
+		int destroyAllComponentsWithIDs(const int* ids, int count);
+
+		/// <summary>
+		/// Destroys all components of every id. The dense list is shrunk once at the end.
+		/// </summary>
+		/// <param name="ids">ID tags of components.</param>
+		/// <returns>Number of components destroyed.</returns>
+		template<class IDAllocator>
+		int destroyAllComponentsWithIDs(const std::vector<int, IDAllocator>& ids);
+
+		/// <summary>
+		/// Replaces values of component with id at first found 
+		/// component. If compoenent does not exists this does nothing.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="replacement">Values to replace compoennt with.</param>
+		void replaceComponentWithID(int id, T& replacement);
+
+		/// <summary>
+		/// Replaces values of component with id at index position with passed 
+		/// component. If compoenent does not exists this does nothing.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">Index position of component.</param>
+		/// <param name="replacement">Values to replace compoennt with.</param>
+		void replaceComponentWithIDAtIndex(int id, int index, T& replacement);
+
+		/// <summary>
+		/// Sets whether the first component with id is active. Inactive components are kept
+		/// after the active ones so update skips them without checking each one. O(1).
+		/// Does nothing if the component does not exist.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="active">Whether the component should update.</param>
+		void setComponentActiveWithID(int id, bool active);
+
+		/// <summary>
+		/// Sets whether the first component of entity is active.
+		/// Does nothing if the handle is stale.
+		/// </summary>
+		/// <param name="entity">Handle of the entity.</param>
+		/// <param name="active">Whether the component should update.</param>
+		void setComponentActiveWithID(Entity entity, bool active);
+
+		/// <summary>
+		/// Sets whether the component with id at index is active.
+		/// Does nothing if indexed position doesn't exist.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">Index position of component.</param>
+		/// <param name="active">Whether the component should update.</param>
+		void setComponentActiveWithIDAtIndex(int id, int index, bool active);
+
+		/// <summary>
+		/// Sets whether the first component with id is active. This is the way to turn a stored
+		/// component on or off, see setComponentActiveWithID.
+		/// </summary>
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="active">Whether the component should update.</param>
+		void setActive(int id, bool active);
+
+		/// <summary>
+		/// Sets whether the first component of entity is active.
+		/// Does nothing if the handle is stale.
+		/// </summary>
+		/// <param name="entity">Handle of the entity.</param>
+		/// <param name="active">Whether the component should update.</param>
+		void setActive(Entity entity, bool active);
+
+		/// <summary>
+		/// Clears dense and sparse lists in entity manager.
 		/// </summary>
 		void clear();
 
 		/// <summary>
-		/// Calls reser on sparse list. Effectively tells the array the highest id that will be used/is in use.
+		/// Checks if component with id exists.
 		/// </summary>
-		/// <param name="u"></param>
-		void reserveIDCapacity(int u);
+		/// <param name="id">ID tag of component</param>
+		/// <returns>False if component does not exist, true otherwise.</returns>
+		bool hasComponentWithID(int id);
 
 		/// <summary>
-		/// Calls reserve on dense list.
+		/// Checks if entity is alive and has a component.
 		/// </summary>
-		/// <param name="u">Number of components size to reserve.</param>
-		void reserveComponentCapacity(int u);
+		/// <param name="entity">Handle of the entity.</param>
+		/// <returns>False if the handle is stale or component does not exist, true otherwise.</returns>
+		bool hasComponentWithID(Entity entity);
 
 		/// <summary>
-		/// Checks if component with id exists. Returs false if is doesn't otherwise it returns true.
+		/// Returns ponter to first found component. Returns
+		/// nullptr if component is not found.
 		/// </summary>
-		/// <param name="id">ID of component to check if it exists.</param>
-		/// <returns>True if component has ID, false if not found.</returns>
-		bool has(const int id);
+		/// <param name="id">ID tag of component.</param>
+		/// <returns>Pointer to component. Nullptr if component not found.</returns>
+		pointer getPtrComponentWithID(int id);
 
 		/// <summary>
-		/// Inserts component with ID to dense list. If there is a pooled object this will be initialised with the
-		/// values instead of constructing a new one.
+		/// Returns pointer to first found component of entity.
 		/// </summary>
-		/// <param name="id">ID to tag component with.</param>
-		void insert(const int id);
+		/// <param name="entity">Handle of the entity.</param>
+		/// <returns>Pointer to component. Nullptr if the handle is stale or component not found.</returns>
+		pointer getPtrComponentWithID(Entity entity);
 
 		/// <summary>
-		/// Removes all objects not used in the dense list effectively making dense.size() = dense_vector_size.
+		/// Returns pointer to component with id at indexed position.
+		/// Returns nullptr if component is not found.
 		/// </summary>
-		void removePooledObjects();
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">Index position of component.</param>
+		/// <returns>Pointer to component. Nullptr if component not found.</returns>
+		pointer getPtrComponentWithIDAtIndex(int id, int index);
 
 		/// <summary>
-		/// For adding another component to self. Only use if you are sure there's another component already attached
-		/// as no checks are performed when using this method.
+		/// Returns a reference to the first component found with id.
+		/// Will result in undefined behaviour if the component does
+		/// not exist.
+		/// 
+		/// For SoAStorage types the reference is a SoAStorage::Reference, a copy that writes every listed
+		/// field back when destroyed. Members the storage doesn't list read as their defaults, and of two
+		/// live references to the same component the one destroyed last overwrites the other. Keep one at
+		/// a time and loop with forEachField.
 		/// </summary>
-		/// <param name="id">ID to tag component with.</param>
-		void insertAnotherToSelf(int id);
+		/// <param name="id">ID tag of the component</param>
+		/// <returns>Reference to first found component with ID.</returns>
+		reference getComponentWithID(int id);
 
 		/// <summary>
-		/// Returns pointer to first component found with id. Returns nullptr if not found. If dense list resizes after
-		/// lookup pointer will become invalidated.
+		/// Returns a reference to the first component of entity.
+		/// Will result in undefined behaviour if the component does
+		/// not exist. Use getPtrComponentWithID or hasComponentWithID
+		/// first if the handle can be stale.
 		/// </summary>
-		/// <param name="id">ID of component to be found.</param>
-		/// <returns>Pointer to component.</returns>
-		T* ptrGet(const int id);
+		/// <param name="entity">Handle of the entity.</param>
+		/// <returns>Reference to first found component of entity.</returns>
+		reference getComponentWithID(Entity entity);
 
 		/// <summary>
-		/// Returns pointer to component in dense list at given index relative to id.
-		/// Returns nullptr if not found. If dense list is resized after lookup pointer will be invalidated.
+		/// Returns reference to component at index of id. 
+		/// Will result in undefined behaviour if component does not exist.
 		/// </summary>
-		/// <param name="id">ID of component to return.</param>
-		/// <param name="index">Index of component relative to id.</param>
-		/// <returns>Pointer to component.</returns>
-		T* ptrGetAtIndex(const int id, const int index);
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">Index of component to id.</param>
+		/// <returns>Reference to component at index with id.</returns>
+		reference getComponentWithIDAtIndex(int id, int index);
 
 		/// <summary>
-		/// Retruns reference to first found component with given id in the dense list.
-		/// Results in undefined behaviour if component doesn't exist. Use with caution.
+		/// Returns the first component found with id for reading. The get functions stamp change ticks and
+		/// SoAStorage references write back, the read functions write nothing, so systems that declared
+		/// readsComponents<T>() have to read T through them to run at the same time. Will result in
+		/// undefined behaviour if the component does not exist.
 		/// </summary>
-		/// <param name="id">ID of component to be returned.</param>
-		/// <returns>Reference to component in dense list</returns>
-		T& get(const int id);
+		/// <param name="id">ID tag of the component.</param>
+		/// <returns>Const reference to the component, or a copy of it for SoAStorage.</returns>
+		read_type readComponentWithID(int id);
 
 		/// <summary>
-		/// Returns reference to component with id at index position. Results in undefined behaviour if component doesn't
-		/// exists. Use with caution.
+		/// Returns the first component of entity for reading, see readComponentWithID. Will result in
+		/// undefined behaviour if the component does not exist.
 		/// </summary>
-		/// <param name="id">ID of component to be returned.</param>
-		/// <param name="index">Index of component relative to id to be returned.</param>
-		/// <returns>Reference to Component in dense list.</returns>
-		T& getAtIndex(const int id, const int index);
+		/// <param name="entity">Handle of the entity.</param>
+		/// <returns>Const reference to the component, or a copy of it for SoAStorage.</returns>
+		read_type readComponentWithID(Entity entity);
 
 		/// <summary>
-		/// Returns reference to the dense list of components.
+		/// Returns the component at index of id for reading, see readComponentWithID. Will result in
+		/// undefined behaviour if the component does not exist.
 		/// </summary>
-		/// <returns>Dense list of components</returns>
-		std::vector<T>& getDenseList();
+		/// <param name="id">ID tag of component.</param>
+		/// <param name="index">Index of component to id.</param>
+		/// <returns>Const reference to the component, or a copy of it for SoAStorage.</returns>
+		read_type readComponentWithIDAtIndex(int id, int index);
 
 		/// <summary>
-		/// Emplaces component to end of dense list with given id.
+		/// Reserves sparse id size. If u is smaller than sparse capacity
+		/// this does nothing.
 		/// </summary>
-		/// <param name="id">ID of component to be emplaced</param>
-		/// <param name="emplaced">Component to have it's values emplaced.</param>
-		void emplace(const int id, T&& emplaced);
+		/// <param name="u">Reserve size you wise to set sparse to.</param>
+		void reserveIDCapacity(int u);
 
 		/// <summary>
-		/// Inserts a copy of components values to the end of dense list with given id.
+		/// Reserve the size of dense list capacity. If u is smaller than current
+		/// capacity this does nothing.
 		/// </summary>
-		/// <param name="id">ID of component that notifies sparse.</param>
-		/// <param name="copy">Component to have it's values copied.</param>
-		void insertCopy(const int id, T& copy);
+		/// <param name="u">Reserve size you wish to set dense list as.</param>
+		void reserveComponentCapacity(int u);
 
 		/// <summary>
-		/// Destroys first component found with given id that is closest to the begininng of dense list.
+		/// Returns the amount of components with a given id.
 		/// </summary>
-		/// <param name="id">ID tag of component to be destroyed.</param>
-		/// <returns>True if component is destroyed, false if nothing is destroyed.</returns>
-		bool eraseWithID(const int id);
+		/// <param name="id">ID tag of components</param>
+		/// <returns>Amount of components with a given id.</returns>
+		int getNumberOfComponentsWithID(int id);
+
+		/// <summary>
+		/// Returns the number of components in use by dense pool not including
+		/// pooled components.
+		/// </summary>
+		/// <returns>Amount of active/used components.</returns>
+		int getNumberOfActiveComponents();
+
+		/// <summary>
+		/// Returns id of the system in use.
+		/// </summary>
+		/// <returns>System id.</returns>
+		int getSystemID();
+
+		/// <summary>
+		/// Returns a reference to dense list of components both used and pooled.
+		/// </summary>
+		/// <returns>Vector reference to dense list of all components.</returns>
+		storage_type& getDenseList();
+
+		/// <summary>
+		/// Update loop of components in entity manager.
+		/// </summary>
+		void update();
+
+		/// <summary>
+		/// Set whether you would like the system to run update on each
+		/// component or not. For systems that have no update
+		/// logic it's best to set this to false.
+		/// </summary>
+		/// <param name="allow">True allows update, false skips update.</param>
+		void setCanUpdate(bool allow);
+
+		/// <summary>
+		/// Set whether update splits the dense list into chunks that are updated on
+		/// the threads of World. Only enable this if component updates don't add or
+		/// remove components of this system and don't write to other components
+		/// of the same system. False by default.
+		/// </summary>
+		/// <param name="allow">True updates in parallel, false updates on one thread.</param>
+		void setCanUpdateInParallel(bool allow);
+
+		/// <summary>
+		/// Sets the smallest number of components handed to a thread at a time when
+		/// updating in parallel. Systems with fewer than two chunks of components update
+		/// on one thread. Rounded up so every chunk is a whole number of 64 byte cache lines
+		/// and no two threads write to the same line.
+		/// </summary>
+		/// <param name="size">Smallest number of components per chunk.</param>
+		void setMinimumChunkSize(int size);
+
+		/// <summary>
+		/// Turns keeping the tick each component last changed in on or off. See SparseSet::setChangeTracking.
+		/// </summary>
+		/// <param name="enabled">Whether to track changes.</param>
+		void setChangeTracking(bool enabled);
+
+		/// <summary>
+		/// Marks the component with id at index as changed, for changes made through views, groups or
+		/// the dense list. Does nothing if the component doesn't exist or changes aren't tracked.
+		/// </summary>
+		/// <param name="id">ID tag of the component.</param>
+		/// <param name="index">Index of component relative to id.</param>
+		void markComponentChangedWithID(int id, int index = 0);
+
+		/// <summary>
+		/// Calls function with every component that changed after tick, for example the tick returned
+		/// by the last Registry::advanceChangeTick of the caller. See SparseSet::forEachChangedSince.
+		/// </summary>
+		/// <param name="tick">Last tick already seen by the caller.</param>
+		/// <param name="function">Called with a reference to each changed component.</param>
+		template<class Function>
+		void forEachChangedSince(std::uint32_t tick, Function function);
+
+		/// <summary>
+		/// Calls function with references to Fields of every active component, for example
+		/// particles.forEachField<&Particle::x, &Particle::vx>([](float& x, float& vx) { x += vx; });
+		/// See SparseSet::forEachField. For SoAStorage this is the loop that copies no component.
+		/// </summary>
+		/// <typeparam name="Fields">Pointers to data members of T, listed in the storage for SoAStorage.</typeparam>
+		/// <param name="function">Called with a reference to each field of each active component.</param>
+		template<auto... Fields, class Function>
+		void forEachField(Function function);
 
 		/// <summary>
-		/// Destroys all component with a given id.
+		/// Turns recording the ids whose components of T are added, removed or replaced on or off, so
+		/// they can be handled in one pass per frame instead of one at a time inside initialise.
+		/// Off by default. Turning it off empties the lists.
 		/// </summary>
-		/// <param name="id">ID of components to be destroyed.</param>
-		/// <returns>True if components are destroyed, false if nothing is destroyed.</returns>
-		bool eraseAllWithID(const int id);
+		/// <param name="enabled">Whether to record.</param>
+		void setObserving(bool enabled);
 
 		/// <summary>
-		/// Destroys component with id tag at the given index. If component can't be found this
-		/// does nothing.
+		/// Ids that gained a component of T since the list was last drained or cleared.
 		/// </summary>
-		/// <param name="id"></param>
-		/// <param name="index"></param>
-		/// <returns></returns>
-		bool eraseWithIDAtIndex(const int id, int index);
+		IDSet& getAddedIDs();
 
 		/// <summary>
-		/// Removes first component found closest to the beginning of the dense list. Removed component
-		/// is placed into a pool.
+		/// Ids that lost a component of T since the list was last drained or cleared.
 		/// </summary>
-		/// <param name="id">ID tag of component to be removed.</param>
-		/// <returns>True if component removed, false if nothing is removed.</returns>
-		bool removeWithID(const int id);
+		IDSet& getRemovedIDs();
 
 		/// <summary>
-		/// Removes all components with given id. Removed components are moved to a pool.
+		/// Ids that had a component of T replaced since the list was last drained or cleared.
 		/// </summary>
-		/// <param name="id">ID tag of components you want removed.</param>
-		/// <returns>True if all components removed, false if none are removed.</returns>
-		bool removeAllWithID(const int id);
+		IDSet& getReplacedIDs();
 
 		/// <summary>
-		/// Removes all components with given id at index based on position closest
-		/// to dense list begin. Removed components are moved to a pool.
-		/// If index isn't found this will return false.
+		/// Calls function with every id in getAddedIDs() then empties it. See IDSet::drain.
 		/// </summary>
-		/// <param name="id">ID tag of component to be removed.</param>
-		/// <param name="index">Index of component to be removed.</param>
-		/// <returns>True if component removed, false if none are removed.</returns>
-		bool removeWithIDAtIndex(const int id, const int index);
+		/// <param name="function">Called with each id.</param>
+		template<class Function>
+		void drainAdded(Function function);
 
 		/// <summary>
-		/// Returns the number of components that share the given id.
+		/// Calls function with every id in getRemovedIDs() then empties it. See IDSet::drain.
 		/// </summary>
-		/// <param name="id">ID of components you want to check.</param>
-		/// <returns>Number of components with given id.</returns>
-		int numberOfComponentsWithID(const int id);
+		/// <param name="function">Called with each id.</param>
+		template<class Function>
+		void drainRemoved(Function function);
 
 		/// <summary>
-		/// Returns the number of components that are able to run update in dense list.
+		/// Calls function with every id in getReplacedIDs() then empties it. See IDSet::drain.
 		/// </summary>
-		/// <returns>Number of components that can update in dense list.</returns>
-		int getNumberOfActiveComponents();
+		/// <param name="function">Called with each id.</param>
+		template<class Function>
+		void drainReplaced(Function function);
 
 		/// <summary>
-		/// Runs update on every active component in dense list.
+		/// Declares the component types that update reads besides T, for example
+		/// positionSystem.readsComponents<PhysicsComponent>(). Once access is declared
+		/// World can run this system at the same time as systems it does not conflict with.
+		/// Call with no types to declare the system only touches its own components.
+		/// Read them through readComponentWithID. The get functions and Views of SoAStorage types write,
+		/// so reading through them needs writesComponents.
 		/// </summary>
-		void runUpdate();
+		/// <typeparam name="Components">Component types read during update.</typeparam>
+		template<class... Components>
+		void readsComponents();
 
 		/// <summary>
-		/// replaces component values with id that is closest to the start of the dense list.
+		/// Declares the component types that update writes besides T. T is always
+		/// treated as written. Once access is declared World can run this system at
+		/// the same time as systems it does not conflict with.
 		/// </summary>
-		/// <param name="id">ID tag of the component</param>
-		/// <param name="copy">Component values you want copied</param>
-		void replace(const int id, T& copy);
+		/// <typeparam name="Components">Component types written during update.</typeparam>
+		template<class... Components>
+		void writesComponents();
 
 		/// <summary>
-		/// Replace a component with anothers value. If there is no component this does nothing.
+		/// Returns the registry the components belong to.
 		/// </summary>
-		/// <param name="id">ID tag of component</param>
-		/// <param name="componentPosition">whether you want the 1st, 2nd... component</param>
-		/// <param name="copy">Component values you want copied</param>
-		void replace(const int id, int componentPosition, T& copy);
+		/// <returns>Registry of the handle.</returns>
+		Registry& getRegistry();
 
 		/// <summary>
-		/// For debugging purposes, print out all elements containing components
+		/// Returns the id of System<T> without needing a System<T> to exist.
+		/// Assigns the id the first time it is asked for. The id is the same in every registry.
 		/// </summary>
-		void print();
+		/// <returns>System id.</returns>
+		static int staticSystemID();
+
+	protected:
+		SparseSet<T>& entityManager;
+
+	private:
+		Registry& registry;
+		SystemState<T>& state;
 	};
 
-	//Dense set of elements
-	template <class T>
-	std::vector<T> SparseSet<T>::dense = std::vector<T>();
+	template<class T>
+	inline System<T>::System()
+		: System(Registry::current())
+	{
 
-	//Map of elements to dense set indices
-	template <class T>
-	std::vector<std::vector<int>> SparseSet<T>::sparse(0, std::vector<int>(0));
+	}
 
-	// Current size (number of elements)
-	template <class T>
-	int SparseSet<T>::size_dense_vector = 0;
+	template<class T>
+	inline System<T>::System(Registry& registry)
+		: entityManager(registry.getSparseSet<T>()), registry(registry), state(registry.getSystemState<T>())
+	{
 
-	//Current capacity (maximum value + 1)
-	template <class T>
-	int SparseSet<T>::capacity_sparse_vector = 0;
+	}
 
 	template<class T>
-	inline SparseSet<T>::SparseSet()
+	inline int System<T>::staticSystemID()
 	{
-		dense.clear();
-		sparse.clear();
+		static const int systemID = Registry::createNewSystemID();
+		return systemID;
 	}
 
 	template<class T>
-	inline SparseSet<T>::~SparseSet()
+	inline Registry& System<T>::getRegistry()
 	{
+		return registry;
+	}
 
+	template<class T>
+	template<class... Components>
+	inline void System<T>::readsComponents()
+	{
+		int ids[] = { System<Components>::staticSystemID()..., -1 };
+		for (size_t i = 0; i < sizeof...(Components); i++)
+		{
+			SystemState<T>::declareAccess(state.readAccess, ids[i]);
+		}
+		SystemState<T>::declareAccess(state.writeAccess, staticSystemID());
+		state.accessDeclared = true;
+		registry.accessChanged();
 	}
 
 	template<class T>
-	inline typename std::vector<T>::iterator SparseSet<T>::begin()
+	template<class... Components>
+	inline void System<T>::writesComponents()
 	{
-		return dense.begin();
+		int ids[] = { System<Components>::staticSystemID()..., -1 };
+		for (size_t i = 0; i < sizeof...(Components); i++)
+		{
+			SystemState<T>::declareAccess(state.writeAccess, ids[i]);
+		}
+		SystemState<T>::declareAccess(state.writeAccess, staticSystemID());
+		state.accessDeclared = true;
+		registry.accessChanged();
 	}
 
 	template<class T>
-	inline typename std::vector<T>::iterator SparseSet<T>::back()
+	void System<T>::update()
 	{
-		return dense.begin() + (size_dense_vector - 1);
+		state.update();
 	}
 
 	template<class T>
-	inline typename std::vector<T>::iterator SparseSet<T>::end()
+	void System<T>::setCanUpdate(bool allow)
 	{
-		return dense.begin() + size_dense_vector;
+		state.allowUpdate = allow;
 	}
 
 	template<class T>
-	inline int SparseSet<T>::size()
+	void System<T>::setCanUpdateInParallel(bool allow)
 	{
-		return size_dense_vector;
+		state.allowParallelUpdate = allow;
 	}
 
 	template<class T>
-	inline int SparseSet<T>::numberOfIDs()
+	void System<T>::setMinimumChunkSize(int size)
 	{
-		return capacity_sparse_vector;
+		state.minimumChunkSize = std::max(size, 1);
 	}
 
 	template<class T>
-	inline int SparseSet<T>::denseListSize()
+	inline void System<T>::setChangeTracking(bool enabled)
 	{
-		return dense.size();
+		entityManager.setChangeTracking(enabled);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::empty()
+	inline void System<T>::markComponentChangedWithID(int id, int index)
 	{
-		return size_dense_vector == 0;
+		// ptrGetAtIndex stamps the component it finds.
+		entityManager.ptrGetAtIndex(id, index);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::clear()
+	template<class Function>
+	inline void System<T>::forEachChangedSince(std::uint32_t tick, Function function)
 	{
-		dense.clear();
-		dense.resize(0);
-		size_dense_vector = 0;
-		sparse.clear();
-		sparse.resize(0);
-		capacity_sparse_vector = 0;
+		entityManager.forEachChangedSince(tick, function);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::reserveIDCapacity(int u)
+	template<auto... Fields, class Function>
+	inline void System<T>::forEachField(Function function)
 	{
-		if (u > capacity_sparse_vector)
-		{
-			sparse.resize(u);
-			capacity_sparse_vector = u;
-		}
+		entityManager.template forEachField<Fields...>(function);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::reserveComponentCapacity(int u)
+	inline void System<T>::setObserving(bool enabled)
 	{
-		if (u > dense.size())
-		{
-			dense.reserve(u);
-		}
+		entityManager.setObserving(enabled);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::has(const int id)
+	inline IDSet& System<T>::getAddedIDs()
 	{
-		if (id < 0)
-		{
-			return false;
-		}
+		return entityManager.getEvents().added;
+	}
 
-		if (id >= capacity_sparse_vector)
-		{
-			return false;
-		}
+	template<class T>
+	inline IDSet& System<T>::getRemovedIDs()
+	{
+		return entityManager.getEvents().removed;
+	}
 
-		if (size_dense_vector == 0)
-		{
-			return false;
-		}
-		std::vector<int>& sparseCache = sparse[id];
+	template<class T>
+	inline IDSet& System<T>::getReplacedIDs()
+	{
+		return entityManager.getEvents().replaced;
+	}
 
-		if (sparseCache.empty())
-		{
-			return false;
-		}
+	template<class T>
+	template<class Function>
+	inline void System<T>::drainAdded(Function function)
+	{
+		entityManager.getEvents().added.drain(function);
+	}
 
-		return true;
-	} // end has(id)
+	template<class T>
+	template<class Function>
+	inline void System<T>::drainRemoved(Function function)
+	{
+		entityManager.getEvents().removed.drain(function);
+	}
 
 	template<class T>
-	inline void SparseSet<T>::insert(const int id)
+	template<class Function>
+	inline void System<T>::drainReplaced(Function function)
 	{
-		if (id < 0)
-		{
-			return;
-		}
-		if (id >= capacity_sparse_vector)
-		{
-			reserveIDCapacity(id + 1);
-		}
+		entityManager.getEvents().replaced.drain(function);
+	}
+
+	template<class T>
+	void System<T>::addComponentWithID(int id)
+	{
+		entityManager.insert(id);
+	}
 
-		if (dense.size() <= size_dense_vector)
+	template<class T>
+	inline void System<T>::addComponentWithID(Entity entity)
+	{
+		if (registry.isAlive(entity))
 		{
-			defaultInsert(id);
-			return;
+			entityManager.insert(entity.id);
 		}
-		pooledInsert(id);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::defaultInsert(int id)
+	inline void System<T>::addComponentsWithIDs(const int* ids, int count)
 	{
-		dense.emplace_back();
-		T& created = dense[size_dense_vector];
-		created.setBelongsToID(id);
-		created.setActive(true);
-		created.initialise();
+		entityManager.insertRange(ids, count);
+	}
 
-		sparse.at(id).push_back(size_dense_vector);
-		++size_dense_vector;
+	template<class T>
+	template<class IDAllocator>
+	inline void System<T>::addComponentsWithIDs(const std::vector<int, IDAllocator>& ids)
+	{
+		entityManager.insertRange(ids.data(), static_cast<int>(ids.size()));
 	}
 
 	template<class T>
-	inline void SparseSet<T>::pooledInsert(int id)
+	inline void System<T>::addComponentValuesWithID(int id, T& copy)
 	{
-		T& recycaled = dense[size_dense_vector];
-		recycaled.setBelongsToID(id);
-		recycaled.setActive(true);
-		recycaled.initialise();
+		entityManager.insertCopy(id, copy);
+	}
 
-		sparse.at(id).push_back(size_dense_vector);
-		++size_dense_vector;
+	template<class T>
+	inline void System<T>::emplaceComponentWithID(int id, T&& emplaced)
+	{
+		entityManager.emplace(id, std::move(emplaced));
 	}
 
 	template<class T>
-	inline void SparseSet<T>::removePooledObjects()
+	void System<T>::removeComponentWithID(int id)
 	{
-		while (dense.size() > size_dense_vector)
+		entityManager.removeWithID(id);
+	}
+
+	template<class T>
+	inline void System<T>::removeComponentWithID(Entity entity)
+	{
+		if (registry.isAlive(entity))
 		{
-			dense.pop_back();
+			entityManager.removeWithID(entity.id);
 		}
 	}
 
 	template<class T>
-	inline void SparseSet<T>::insertAnotherToSelf(int id)
+	inline void System<T>::removeComponentWithIDAtIndex(int id, int index)
 	{
-		defaultInsert(id);
+		entityManager.removeWithIDAtIndex(id, index);
 	}
 
 	template<class T>
-	inline T* SparseSet<T>::ptrGet(const int id)
+	bool System<T>::removeAllComponentsWithID(int id)
 	{
-		if (!has(id))
-		{
-			return nullptr;
-		}
-		return &dense[sparse.at(id).at(0)];
+		return entityManager.removeAllWithID(id);
 	}
 
 	template<class T>
-	inline T* SparseSet<T>::ptrGetAtIndex(const int id, const int index)
+	inline int System<T>::removeAllComponentsWithIDs(const int* ids, int count)
 	{
-		if (!has(id))
-		{
-			return nullptr;
-		}
-		if (sparse.at(id).size() <= index)
+		return entityManager.removeAllWithIDs(ids, count);
+	}
+
+	template<class T>
+	template<class IDAllocator>
+	inline int System<T>::removeAllComponentsWithIDs(const std::vector<int, IDAllocator>& ids)
+	{
+		return entityManager.removeAllWithIDs(ids.data(), static_cast<int>(ids.size()));
+	}
+
+	template<class T>
+	void System<T>::destroyComponentWithID(int id)
+	{
+		entityManager.eraseWithID(id);
+	}
+
+	template<class T>
+	inline void System<T>::destroyComponentWithID(Entity entity)
+	{
+		if (registry.isAlive(entity))
 		{
-			return nullptr;
+			entityManager.eraseWithID(entity.id);
 		}
-		return &dense[sparse.at(id).at(index)];
 	}
 
 	template<class T>
-	inline T& SparseSet<T>::get(const int id)
+	inline void System<T>::destroyComponentWithIDAtIndex(int id, int index)
+	{
+		entityManager.eraseWithIDAtIndex(id, index);
+	}
+
+	template<class T>
+	bool System<T>::destroyAllComponentsWithID(int id)
 	{
-		return dense[sparse.at(id).at(0)];
+		return entityManager.eraseAllWithID(id);
 	}
 
 	template<class T>
-	inline T& SparseSet<T>::getAtIndex(const int id, const int index)
+	inline int System<T>::destroyAllComponentsWithIDs(const int* ids, int count)
 	{
-		return dense[sparse.at(id).at(index)];
+		return entityManager.eraseAllWithIDs(ids, count);
 	}
 
 	template<class T>
-	inline std::vector<T>& SparseSet<T>::getDenseList()
+	template<class IDAllocator>
+	inline int System<T>::destroyAllComponentsWithIDs(const std::vector<int, IDAllocator>& ids)
 	{
-		return dense;
+		return entityManager.eraseAllWithIDs(ids.data(), static_cast<int>(ids.size()));
 	}
 
 	template<class T>
-	inline void SparseSet<T>::emplace(const int id, T&& emplaced)
+	inline void System<T>::replaceComponentWithID(int id, T& replacement)
 	{
-		if (id < 0)
-		{
-			return;
-		}
+		entityManager.replace(id, replacement);
+	}
 
-		if (id >= capacity_sparse_vector)
+	template<class T>
+	inline void System<T>::replaceComponentWithIDAtIndex(int id, int index, T& replacement)
+	{
+		entityManager.replace(id, index, replacement);
+	}
+
+	template<class T>
+	inline void System<T>::setComponentActiveWithID(int id, bool active)
+	{
+		entityManager.setActiveWithID(id, active);
+	}
+
+	template<class T>
+	inline void System<T>::setComponentActiveWithID(Entity entity, bool active)
+	{
+		if (registry.isAlive(entity))
 		{
-			reserveIDCapacity(id + 1);
+			entityManager.setActiveWithID(entity.id, active);
 		}
+	}
 
-		dense.emplace_back(emplaced);
-		dense[size_dense_vector].setBelongsToID(id);
-		sparse.at(id).push_back(size_dense_vector);
-		++size_dense_vector;
+	template<class T>
+	inline void System<T>::setComponentActiveWithIDAtIndex(int id, int index, bool active)
+	{
+		entityManager.setActiveWithIDAtIndex(id, index, active);
+	}
+
+	template<class T>
+	inline void System<T>::setActive(int id, bool active)
+	{
+		entityManager.setActiveWithID(id, active);
+	}
+
+	template<class T>
+	inline void System<T>::setActive(Entity entity, bool active)
+	{
+		setComponentActiveWithID(entity, active);
+	}
+
+	template<class T>
+	inline void System<T>::clear()
+	{
+		entityManager.clear();
 	}
 
 	template<class T>
-	inline void SparseSet<T>::insertCopy(const int id, T& copy)
+	bool System<T>::hasComponentWithID(int id)
 	{
-		if (id < 0)
-		{
-			return;
-		}
-
-		if (id >= capacity_sparse_vector)
-		{
-			reserveIDCapacity(id + 1);
-		}
-		if (dense.size() <= size_dense_vector)
-		{
-			dense.push_back(copy);
-			dense[size_dense_vector].setBelongsToID(id);
-			sparse.at(id).push_back(size_dense_vector);
-			++size_dense_vector;
-			return;
-		}
-		dense[size_dense_vector] = copy;
-		dense[size_dense_vector].setBelongsToID(id);
-		sparse.at(id).push_back(size_dense_vector);
-		++size_dense_vector;
+		return entityManager.has(id);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::eraseWithID(const int id)
+	inline bool System<T>::hasComponentWithID(Entity entity)
 	{
-		if (!removeWithID(id))
-		{
-			return false;
-		}
-		dense.pop_back();
-		return true;
+		return registry.isAlive(entity) && entityManager.has(entity.id);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::eraseAllWithID(const int id)
+	typename System<T>::pointer System<T>::getPtrComponentWithID(int id)
 	{
-		if (!has(id))
-		{
-			return false;
-		}
-		while (sparse.at(id).size() > 0)
-		{
-			rem(id);
-			dense.pop_back();
-		}
-		return true;
+		return entityManager.ptrGet(id);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::eraseWithIDAtIndex(const int id, int index)
+	inline typename System<T>::pointer System<T>::getPtrComponentWithID(Entity entity)
 	{
-		if (!removeWithIDAtIndex(id, index))
+		if (!registry.isAlive(entity))
 		{
-			return false;
+			return nullptr;
 		}
-		dense.pop_back();
-		return true;
+		return entityManager.ptrGet(entity.id);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::removeWithID(const int id)
+	typename System<T>::pointer System<T>::getPtrComponentWithIDAtIndex(int id, int index)
 	{
-		if (!has(id))
-		{
-			return false;
-		}
-		rem(id);
-		return true;
+		return entityManager.ptrGetAtIndex(id, index);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::removeAllWithID(const int id)
+	typename System<T>::reference System<T>::getComponentWithID(int id)
 	{
-		if (!has(id))
-		{
-			return false;
-		}
-		while (!sparse.at(id).empty())
-		{
-			rem(id);
-		}
-		return true;
+		return entityManager.get(id);
 	}
 
 	template<class T>
-	inline bool SparseSet<T>::removeWithIDAtIndex(const int id, const int index)
+	inline typename System<T>::reference System<T>::getComponentWithID(Entity entity)
 	{
-		if (!has(id))
-		{
-			return false;
-		}
-		if (sparse[id].size() <= index)
-		{
-			return false;
-		}
-		rem(id, index);
-		return true;
+		return entityManager.get(entity.id);
 	}
 
 	template<class T>
-	inline int SparseSet<T>::numberOfComponentsWithID(const int id)
+	typename System<T>::reference System<T>::getComponentWithIDAtIndex(int id, int index)
 	{
-		if (!has(id))
-		{
-			return 0;
-		}
-		return sparse.at(id).size();
+		return entityManager.getAtIndex(id, index);
 	}
 
 	template<class T>
-	inline int SparseSet<T>::getNumberOfActiveComponents()
+	inline typename System<T>::read_type System<T>::readComponentWithID(int id)
 	{
-		return size_dense_vector;
+		return entityManager.read(id);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::runUpdate()
+	inline typename System<T>::read_type System<T>::readComponentWithID(Entity entity)
 	{
-		for (int i = 0; i < size_dense_vector; i++)
-		{
-			if (!dense[i].isActive())
-			{
-				continue;
-			}
-			dense.at(i).update();
-		}
+		return entityManager.read(entity.id);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::replace(const int id, T& copy)
+	inline typename System<T>::read_type System<T>::readComponentWithIDAtIndex(int id, int index)
 	{
-		if (!has(id))
-		{
-			return;
-		}
-		copy.setBelongsToID(id);
-		dense.at(sparse.at(id).at(0)) = copy;
+		return entityManager.readAtIndex(id, index);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::replace(const int id, int componentPosition, T& copy)
+	typename System<T>::storage_type& System<T>::getDenseList()
 	{
-		if (!has(id))
-		{
-			return;
-		}
-		if (componentPosition >= sparse.at(id).size())
-		{
-			return;
-		}
-		copy.setBelongsToID(id);
-		dense.at(sparse.at(id).at(componentPosition)) = copy;
+		return entityManager.getDenseList();
 	}
 
 	template<class T>
-	inline void SparseSet<T>::print()
+	inline void System<T>::reserveIDCapacity(int u)
 	{
-		if (size_dense_vector == 0)
-		{
-			printf("no components in dense array");
-			printf("\n");
-			return;
-		}
-		for (int i = 0; i < size_dense_vector; i++)
-		{
-			printf("%d, ", dense[i].belongsToID());
-		}
-		printf("\n");
+		entityManager.reserveIDCapacity(u);
 	}
 
 	template<class T>
-	inline void SparseSet<T>::rem(int id, int index)
+	inline void System<T>::reserveComponentCapacity(int u)
 	{
-		int removedComponentPosition = sparse.at(id).at(index);
-
-		if (removedComponentPosition == size_dense_vector - 1)
-		{
-			sparse.at(id).erase(sparse.at(id).begin() + index);
-			--size_dense_vector;
-			return;
-		}
+		entityManager.reserveComponentCapacity(u);
+	}
 
-		dense[removedComponentPosition].setActive(false);
+	template<class T>
+	int System<T>::getNumberOfActiveComponents()
+	{
+		return entityManager.getNumberOfActiveComponents();
+	}
 
-		int lastElementBelongID = dense[size_dense_vector - 1].belongsToID();
+	template<class T>
+	int System<T>::getNumberOfComponentsWithID(int id)
+	{
+		return entityManager.numberOfComponentsWithID(id);
+	}
 
-		sparse[lastElementBelongID].back() = removedComponentPosition;
-		dense[removedComponentPosition] = dense[size_dense_vector - 1];
+	template<class T>
+	int System<T>::getSystemID()
+	{
+		return staticSystemID();
+	}
+} // End System<T>
 
-		if (sparse[lastElementBelongID].size() > 1)
+namespace decs
+{
+	template<class... Components>
+	inline Signature Signature::of()
+	{
+		Signature signature;
+		int ids[] = { System<Components>::staticSystemID()..., -1 };
+		for (size_t i = 0; i < sizeof...(Components); i++)
 		{
-			std::sort(sparse[lastElementBelongID].begin(), sparse[lastElementBelongID].end());
+			signature.set(ids[i]);
 		}
+		return signature;
+	}
+} // End Signature::of
 
-		sparse.at(id).erase(sparse.at(id).begin() + index);
-		--size_dense_vector;
-	} // End rem(id);
-
-} // End sparse
-
-
-
-// SystemBase
 namespace decs
 {
 	/// <summary>
-	/// Base class of System. Used by Entity for when storing 
-	/// a deque of systems to check when deleting entities.
-	/// Do not construct or use this by itself as it will do nothing.
+	/// Joins the dense lists of several component types. Walks the smallest list and finds the
+	/// components with the same id in the others, so callers get every component of an entity
+	/// without calling getComponentWithID on each system.
+	/// 
+	/// When another list holds the same id at the same position, which is the case when components
+	/// were added to entities in the same order, that position is used without a sparse lookup.
+	/// Lists that line up fully are joined with no lookups at all.
+	/// Entities missing any of the types or with any of the components inactive are skipped.
+	/// An entity with several components of one type is paired by position when the lists line
+	/// up, otherwise with its first component.
+	/// 
+	/// Adding or removing components of the joined types while iterating is not supported,
+	/// record those in a CommandBuffer instead.
+	/// 
+	/// A View joins the components of one Registry and is cheap to construct, make one where it is needed.
 	/// </summary>
-	class SystemBase
+	/// <typeparam name="Components">Component types to join.</typeparam>
+	template<class... Components>
+	class View
 	{
-	public:
-		SystemBase();
-
-		~SystemBase();
-
-		/// <summary>
-		/// Pure virtual function for remove all components that World 
-		/// needs access to through Systems<T>.
-		/// </summary>
-		/// <param name="entityId"></param>
-		/// <returns>True if components removed false if nothing removed.</returns>
-		virtual bool removeAllComponentsWithID(int entityId) = 0;
+		static_assert(sizeof...(Components) > 0, "View needs at least one component type");
 
-		/// <summary>
-		/// Pure virtual function for destroying all 
-		/// components that World needs access to through Systems<T>
-		/// </summary>
-		/// <param name="entityId"></param>
-		/// <returns>True if components destroyed, false otherwise.</returns>
-		virtual bool destroyAllComponentsWithID(int entityId) = 0;
+		static constexpr int componentCount = sizeof...(Components);
 
-		/// <summary>
-		/// Pure virtual function for checking id has component
-		/// that World needs access to through System<T>
-		/// </summary>
-		/// <param name="entityID">ID tag of component</param>
-		/// <returns>True if component with tag exists, false otherwise.</returns>
-		virtual bool hasComponentWithID(int entityID) = 0;
+		template<size_t I>
+		using SetAt = SparseSet<typename std::tuple_element<I, std::tuple<Components...>>::type>;
 
-		/// <summary>
-		/// Pure virtual function that returns id of System<T> 
-		/// that World needs access to.
-		/// </summary>
-		/// <returns>ID of System<T></returns>
-		virtual int getSystemID() = 0;
+	public:
+		typedef std::tuple<typename SparseSet<Components>::reference...> value_type;
 
 		/// <summary>
-		/// Pure virtual function for update call that World needs.
+		/// Joins the components in the registry bound to the calling thread.
 		/// </summary>
-		virtual void update() = 0;
+		View();
 
 		/// <summary>
-		/// Pure virutal function for finding the highest id in use by
-		/// a entity manager that World needs access to.
+		/// Joins the components in registry.
 		/// </summary>
-		/// <returns>Id of highest id in use.</returns>
-		virtual int highestIDUsed() = 0;
+		/// <param name="registry">Registry that owns the components.</param>
+		explicit View(Registry& registry);
 
 		/// <summary>
-		/// Pure virtual function that returns number of 
-		/// active components in dense list of entity manager. 
-		/// Used for access by World.
+		/// Position in the joined lists. Dereferencing returns a tuple of references to the
+		/// components of one entity. Only available when every type is stored in a std::vector,
+		/// use each for components with SoAStorage.
 		/// </summary>
-		/// <returns></returns>
-		virtual int getNumberOfActiveComponents() = 0;
+		class iterator
+		{
+		public:
+			iterator(const View& view, int driver, int position);
 
-		/// <summary>
-		/// Pure virtual function for clearing entitiy manger that needs
-		/// to be accessed by World.
-		/// </summary>
-		virtual void clear() = 0;
-	};
+			value_type operator*() const;
 
-	inline SystemBase::SystemBase() {}
+			/// <summary>
+			/// Returns the id of the entity the iterator is at.
+			/// </summary>
+			int id() const;
 
-	inline SystemBase::~SystemBase() {}
+			iterator& operator++();
 
-} // End SystemBase
+			bool operator==(const iterator& other) const;
 
-namespace decs
-{
-	/// <summary>
-	/// World class for assigning new ids and destroying, cleaning up entities.
-	/// </summary>
-	class World
-	{
-	private:
-		// Storage of existing systems
-		static int assignableSystemID;
-		static std::vector<std::reference_wrapper<SystemBase>> systems;
+			bool operator!=(const iterator& other) const;
 
-		static int nextAvailableID;
-		static std::deque<int> reusableIds;
+		private:
+			const View* view;
+			int driver;
+			int position;
+			int indices[componentCount];
 
-		static std::deque<int> destroyListPool;
-		static std::deque<int> destroyList;
+			void skipUnmatched();
 
-		static float deltaTime;
+			template<size_t... I>
+			value_type get(std::index_sequence<I...>) const;
+		};
 
-	public:
 		/// <summary>
-		/// Used by System automatically upon construction of an System.
-		/// Returns true if it is added successfully, 
-		/// false if it does not get added.
+		/// Calls function(id, components...) for every entity that has all component types.
+		/// Components are passed as references, or as Reference for SoAStorage types,
+		/// so function can take them as T&.
 		/// </summary>
-		/// <param name="system"> "The System that you wish 
-		/// to have added to the deque."</param>
-		/// <returns>description</returns>
-		static bool addSystem(SystemBase& system);
+		/// <param name="function">Called for every matching entity.</param>
+		template<class Function>
+		void each(Function function);
 
-		/// <summary>
-		/// Set new delta time. Do this at the begininng of every frame to make sure your programs are frame rate
-		/// independant;
-		/// </summary>
-		/// <param name="dt">delta time float to be passed</param>
-		static void setDeltaTime(float dt);
+		iterator begin();
 
-		/// <summary>
-		/// Get delta time of current frame
-		/// </summary>
-		static float getDeltaTime();
-		/// <summary>
-		/// Returns ID to be used. Will use one from reusable 
-		/// ids if one is available.
-		/// </summary>
-		/// <returns>Id for use.</returns>
-		static int createNewID();
+		iterator end();
 
 		/// <summary>
-		/// Returns ID of a new entity then increments next assignable id. 
-		/// This is called by Systems on construction if 
-		/// they have no id assigned to them yet.
+		/// Returns the position in Components of the type with the fewest components.
 		/// </summary>
-		/// <returns>id of entity</returns>
-		static int createNewSystemID();
+		int smallest() const;
 
-		/// <summary>
-		/// Calls update on all systems that have 
-		/// set allowUpdate to true. 
-		/// </summary>
-		static void update();
+	private:
+		std::tuple<SparseSet<Components>*...> sets;
 
 		/// <summary>
-		/// Marks entity to be destroyed. 
-		/// If using built in update these entites are removed 
-		/// or destroyed at the end of the update cycle.
+		/// Returns the components of type I.
 		/// </summary>
-		/// <param name="entityID">ID of components to be removed.</param>
-		/// <param name="poolComponents">Whether to store 
-		/// components in a pool or not. True by default.</param>
-		static void destroyEntity(int entityID, bool poolComponents = true);
+		template<size_t I>
+		SetAt<I>& set() const;
 
 		/// <summary>
-		/// Marks all ids and components for destruction. 
-		/// If using built in update components will be destroyed at 
-		/// the end of the update cycle.
+		/// Finds the component of type I belonging to id, trying position first.
 		/// </summary>
-		/// <param name="poolComponents">Whether to store 
-		/// components for reuse or not. Set to false by default.</param>
-		static void destroyAllEntities(bool poolComponents = false);
+		template<size_t I>
+		bool find(int id, int position, int& index) const;
 
 		/// <summary>
-		/// Finds all ids used that have no components and 
-		/// places them into the id pool to be reused.
+		/// Fills indices with the components of the entity at position in list Driver.
+		/// Returns false if the entity is missing a type or a component is inactive.
 		/// </summary>
-		static void destroyOrphanedEntities();
+		template<size_t Driver>
+		bool match(int position, int* indices) const;
 
-		/// <summary>
-		/// Destroys marked components. This is called automatically 
-		/// with the built in update.
-		/// 
-		/// When using custom updates this needs to be 
-		/// called by the user.
-		/// </summary>
-		static void destroyMarked();
+		template<size_t Driver, size_t... I>
+		bool findOthers(int id, int position, int* indices, std::index_sequence<I...>) const;
 
-		/// <summary>
-		/// Returns what the next availble id will be but doesn't increment. 
-		/// Instead use World::createNewId() to assign a new id as this will use a pool and
-		/// auto increment to the next available.
-		/// </summary>
-		/// <returns>an int that the next available id will be not including those in the pool</returns>
-		static int getNextAvailableEntityID();
+		template<size_t... I>
+		bool matchFrom(int driver, int position, int* indices, std::index_sequence<I...>) const;
+
+		template<size_t... I>
+		int sizeOf(int driver, std::index_sequence<I...>) const;
+
+		template<class Function, size_t... I>
+		void eachFrom(int driver, Function& function, std::index_sequence<I...>) const;
+
+		template<size_t Driver, class Function>
+		void eachDrivenBy(Function& function) const;
+
+		template<size_t I, class Function, class... References>
+		void invoke(Function& function, int id, const int* indices, References&... references) const;
 	};
 
-	inline void World::setDeltaTime(float dt)
+	template<class... Components>
+	inline View<Components...>::View()
+		: View(Registry::current())
 	{
-		deltaTime = dt;
+
 	}
 
-	inline float World::getDeltaTime()
+	template<class... Components>
+	inline View<Components...>::View(Registry& registry)
+		: sets(&registry.getSparseSet<Components>()...)
 	{
-		return deltaTime;
+
 	}
 
-	inline int World::createNewID()
+	template<class... Components>
+	template<size_t I>
+	inline typename View<Components...>::template SetAt<I>& View<Components...>::set() const
 	{
-		if (reusableIds.empty())
-		{
-			return nextAvailableID++;
-		}
-		int returnedID = reusableIds.back();
-		reusableIds.pop_back();
-		return returnedID;
+		return *std::get<I>(sets);
 	}
 
-	inline bool World::addSystem(SystemBase& system)
+	template<class... Components>
+	template<class Function>
+	inline void View<Components...>::each(Function function)
 	{
-		size_t size = systems.size();
-
-		for (int i = 0; i < size; i++)
-		{
-			if (system.getSystemID() == systems.at(i).get().getSystemID())
-			{
-				return false;
-			}
-		}
-		systems.emplace_back(system);
-		return true;
+		eachFrom(smallest(), function, std::make_index_sequence<componentCount>());
 	}
 
-	inline int World::createNewSystemID()
+	template<class... Components>
+	inline typename View<Components...>::iterator View<Components...>::begin()
 	{
-		return assignableSystemID++;
+		return iterator(*this, smallest(), 0);
 	}
 
-	inline void World::update()
+	template<class... Components>
+	inline typename View<Components...>::iterator View<Components...>::end()
 	{
-		size_t size = systems.size();
-		for (int i = 0; i < size; i++)
-		{
-			systems.at(i).get().update();
-		}
-		// Clean up components marked for destruction.
-		destroyMarked();
+		int driver = smallest();
+		return iterator(*this, driver, sizeOf(driver, std::make_index_sequence<componentCount>()));
 	}
 
-	inline void World::destroyEntity(int entityID, bool poolComponents)
+	template<class... Components>
+	inline int View<Components...>::smallest() const
 	{
-		size_t size = systems.size();
-
-		for (int i = 0; i < size; i++)
+		int sizes[] = { std::get<SparseSet<Components>*>(sets)->size_active_range... };
+		int driver = 0;
+		for (int i = 1; i < componentCount; i++)
 		{
-			if (systems.at(i).get().hasComponentWithID(entityID))
+			if (sizes[i] < sizes[driver])
 			{
-				if (poolComponents)
-				{
-					destroyListPool.push_back(entityID);
-					break;
-				}
-				destroyList.push_back(entityID);
-				break;
+				driver = i;
 			}
 		}
+		return driver;
 	}
 
-	inline void World::destroyAllEntities(bool poolComponents)
+	template<class... Components>
+	template<size_t I>
+	inline bool View<Components...>::find(int id, int position, int& index) const
 	{
-		size_t systemSize = systems.size();
-		int highestID = 0;
-
-		for (int i = 0; i < systemSize; i++)
+		SetAt<I>& components = set<I>();
+		if (position < components.size_active_range && belongsToIDAt(components.dense, position) == id)
 		{
-			int highestSystemID = systems.at(i).get().highestIDUsed();
-			if (highestSystemID > highestID)
-			{
-				highestID = highestSystemID;
-			}
+			index = position;
+			return true;
 		}
-
-		for (int j = 0; j <= highestID; j++)
+		if (id >= components.capacity_sparse_vector || !components.sparse.contains(id))
 		{
-			destroyEntity(j, poolComponents);
+			return false;
 		}
+		// The first component of an id is active if any of its components are.
+		index = components.sparse.first(id);
+		return index < components.size_active_range;
 	}
 
-	inline void World::destroyOrphanedEntities()
+	template<class... Components>
+	template<size_t Driver>
+	inline bool View<Components...>::match(int position, int* indices) const
 	{
-		size_t systemSize = systems.size();
-		int highestID = 0;
+		SetAt<Driver>& components = set<Driver>();
+		indices[Driver] = position;
+		return findOthers<Driver>(belongsToIDAt(components.dense, position), position, indices, std::make_index_sequence<componentCount>());
+	}
 
-		for (int i = 0; i < systemSize; i++)
-		{
-			int highestSystemID = systems.at(i).get().highestIDUsed();
+	template<class... Components>
+	template<size_t Driver, size_t... I>
+	inline bool View<Components...>::findOthers(int id, int position, int* indices, std::index_sequence<I...>) const
+	{
+		return ((I == Driver || find<I>(id, position, indices[I])) && ...);
+	}
 
-			if (highestSystemID > highestID)
-			{
-				highestID = highestSystemID;
-			}
-		}
+	template<class... Components>
+	template<size_t... I>
+	inline bool View<Components...>::matchFrom(int driver, int position, int* indices, std::index_sequence<I...>) const
+	{
+		static bool (View::*const matchers[])(int, int*) const = { &View::template match<I>... };
+		return (this->*matchers[driver])(position, indices);
+	}
+
+	template<class... Components>
+	template<size_t... I>
+	inline int View<Components...>::sizeOf(int driver, std::index_sequence<I...>) const
+	{
+		int sizes[] = { set<I>().size_active_range... };
+		return sizes[driver];
+	}
 
-		std::deque<int> destroyList;
-		bool destroyable = false;
+	template<class... Components>
+	template<class Function, size_t... I>
+	inline void View<Components...>::eachFrom(int driver, Function& function, std::index_sequence<I...>) const
+	{
+		// Every driver gets its own loop so the lookups inside are resolved at compile time.
+		((driver == static_cast<int>(I) ? eachDrivenBy<I>(function) : void()), ...);
+	}
 
-		for (int i = 0; i <= highestID; i++)
+	template<class... Components>
+	template<size_t Driver, class Function>
+	inline void View<Components...>::eachDrivenBy(Function& function) const
+	{
+		SetAt<Driver>& components = set<Driver>();
+		int indices[componentCount];
+		int size = components.size_active_range;
+		for (int position = 0; position < size; position++)
 		{
-			for (int systemID = 0; systemID < systemSize; systemID++)
+			if (match<Driver>(position, indices))
 			{
-				if (!systems.at(systemID).get().hasComponentWithID(i))
-				{
-					destroyList.push_back(i);
-					break;
-				}
+				invoke<0>(function, belongsToIDAt(components.dense, position), indices);
 			}
 		}
+	}
 
-		while (destroyList.empty() == false)
-		{
-			reusableIds.push_back(destroyList.back());
-			destroyList.pop_back();
-		}
-	} // End destroyOrphanedentitiies();
-
-	inline void World::destroyMarked()
+	template<class... Components>
+	template<size_t I, class Function, class... References>
+	inline void View<Components...>::invoke(Function& function, int id, const int* indices, References&... references) const
 	{
-		while (destroyList.empty() == false)
+		if constexpr (I == componentCount)
 		{
-			for (int i = 0; i < systems.size(); i++)
-			{
-				systems.at(i).get().destroyAllComponentsWithID(destroyList.back());
-			}
-			reusableIds.push_back(destroyList.back());
-			destroyList.pop_back();
+			function(id, references...);
 		}
-		while (destroyListPool.empty() == false)
+		else
 		{
-			for (int i = 0; i < systems.size(); i++)
-			{
-				systems.at(i).get().removeAllComponentsWithID(destroyListPool.back());
-			}
-			reusableIds.push_back(destroyListPool.back());
-			destroyListPool.pop_back();
+			// Binding to auto&& keeps SoAStorage references alive until function returns.
+			auto&& component = set<I>().dense[indices[I]];
+			invoke<I + 1>(function, id, indices, references..., component);
 		}
-	} // end Destroy();
+	}
 
-	inline int World::getNextAvailableEntityID()
+	template<class... Components>
+	inline View<Components...>::iterator::iterator(const View& view, int driver, int position)
+		: view(&view), driver(driver), position(position)
 	{
-		return nextAvailableID;
+		skipUnmatched();
 	}
 
-	int World::assignableSystemID = 0;
-	std::vector<std::reference_wrapper<SystemBase>> World::systems = std::vector<std::reference_wrapper<SystemBase>>();
-	std::deque<int> World::reusableIds = std::deque<int>();
-	std::deque<int> World::destroyListPool = std::deque<int>();
-	std::deque<int> World::destroyList = std::deque<int>();
-	int World::nextAvailableID = 0;
-	float World::deltaTime = 0;
-} // End World class
-
-namespace decs
-{
-	/// <summary>
-	/// System class that inherits struct or class that has inherited from decs::Component.
-	/// This handles all get, find, destroy and remove component logic as well
-	/// as handling the update call.
-	/// </summary>
-	/// <typeparam name="T">Class/Struct that inherits from decs::Component.</typeparam>
-	template<class T>
-	class System : SystemBase
+	template<class... Components>
+	inline typename View<Components...>::value_type View<Components...>::iterator::operator*() const
 	{
-		static_assert(std::is_convertible<T*, Component*>::value, "class<T> Must inherit from Component");
-	public:
-		System();
-
-		/// <summary>
-		/// Adds default component to id. Sets component to active and then calls 
-		/// initialise.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		void addComponentWithID(int id);
-
-		/// <summary>
-		/// Pushes back component to of id index position.
-		/// Does not initialise or set component to active.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="copy">Component values to push back.</param>
-		void addComponentValuesWithID(int id, T& copy);
-
-		/// <summary>
-		/// Emplaces values of component to back of id indexed position.
-		/// Does not initialise or set component to active.
-		/// </summary>
-		/// <param name="id">ID tag of compponent.</param>
-		/// <param name="emplaced">Component values to emplace back.</param>
-		void emplaceComponentWithID(int id, T&& emplaced);
-
-		/// <summary>
-		/// Marks component first found in dense list for removal
-		/// into a pool.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		void removeComponentWithID(int id);
-
-		/// <summary>
-		/// Marks components with id tag at given index for removal into
-		/// a pool. Does nothing if indexed position doesn't exist.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="index">Index position of component.</param>
-		void removeComponentWithIDAtIndex(int id, int index);
-
-		/// <summary>
-		/// Marks all components found with id for removal into a pool.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <returns>True if components removed, false otherwise.</returns>
-		bool removeAllComponentsWithID(int id) override;
-
-		/// <summary>
-		/// Marks component with given id at first indexed position
-		/// for destruction. Components are removed at the end of a update cycle.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		void destroyComponentWithID(int id);
+		static_assert(std::conjunction<std::is_reference<typename SparseSet<Components>::reference>...>::value,
+			"View iterators need every component stored in a std::vector, use View::each for SoAStorage");
+		return get(std::make_index_sequence<componentCount>());
+	}
 
-		/// <summary>
-		/// Marks component with given id at index position
-		/// for destruction. Components are removed at the end of a update cycle.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="index">indexed position of component.</param>
-		void destroyComponentWithIDAtIndex(int id, int index);
+	template<class... Components>
+	template<size_t... I>
+	inline typename View<Components...>::value_type View<Components...>::iterator::get(std::index_sequence<I...>) const
+	{
+		return value_type(view->template set<I>().dense[indices[I]]...);
+	}
 
-		/// <summary>
-		/// Marks all components with given id at index position
-		/// for destruction. Components are removed at the end of a update cycle.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <returns>True if components destroyed, false otherwise.</returns>
-		bool destroyAllComponentsWithID(int id) override;
+	template<class... Components>
+	inline int View<Components...>::iterator::id() const
+	{
+		return std::get<0>(**this).belongsToID();
+	}
 
-		/// <summary>
-		/// Replaces values of component with id at first found 
-		/// component. If compoenent does not exists this does nothing.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="replacement">Values to replace compoennt with.</param>
-		void replaceComponentWithID(int id, T& replacement);
+	template<class... Components>
+	inline typename View<Components...>::iterator& View<Components...>::iterator::operator++()
+	{
+		++position;
+		skipUnmatched();
+		return *this;
+	}
 
-		/// <summary>
-		/// Replaces values of component with id at index position with passed 
-		/// component. If compoenent does not exists this does nothing.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="index">Index position of component.</param>
-		/// <param name="replacement">Values to replace compoennt with.</param>
-		void replaceComponentWithIDAtIndex(int id, int index, T& replacement);
+	template<class... Components>
+	inline bool View<Components...>::iterator::operator==(const iterator& other) const
+	{
+		return position == other.position && driver == other.driver && view == other.view;
+	}
 
-		/// <summary>
-		/// Clears dense and sparse lists in entity manager.
-		/// </summary>
-		void clear() override;
+	template<class... Components>
+	inline bool View<Components...>::iterator::operator!=(const iterator& other) const
+	{
+		return !(*this == other);
+	}
 
-		/// <summary>
-		/// Checks if component with id exists.
-		/// </summary>
-		/// <param name="id">ID tag of component</param>
-		/// <returns>False if component does not exist, true otherwise.</returns>
-		bool hasComponentWithID(int id) override;
+	template<class... Components>
+	inline void View<Components...>::iterator::skipUnmatched()
+	{
+		int size = view->sizeOf(driver, std::make_index_sequence<componentCount>());
+		while (position < size && !view->matchFrom(driver, position, indices, std::make_index_sequence<componentCount>()))
+		{
+			++position;
+		}
+	}
+} // End View
 
-		/// <summary>
-		/// Returns ponter to first found component. Returns
-		/// nullptr if component is not found.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <returns>Pointer to component. Nullptr if component not found.</returns>
-		T* getPtrComponentWithID(int id);
+namespace decs
+{
+	/// <summary>
+	/// Packing state of an owning group in one Registry. The registry creates it the first time
+	/// the group is used and every Group<Owned...> made for that registry works on it.
+	/// </summary>
+	/// <typeparam name="Owned">Component types owned by the group.</typeparam>
+	template<class... Owned>
+	class GroupState : public GroupHooks
+	{
+	public:
+		explicit GroupState(Registry& registry);
 
 		/// <summary>
-		/// Returns pointer to component with id at indexed position.
-		/// Returns nullptr if component is not found.
+		/// Returns the group type id, shared by every Registry.
 		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="index">Index position of component.</param>
-		/// <returns>Pointer to component. Nullptr if component not found.</returns>
-		T* getPtrComponentWithIDAtIndex(int id, int index);
+		static int groupID();
 
 		/// <summary>
-		/// Returns a reference to the first component found with id.
-		/// Will result in undefined behaviour if the component does
-		/// not exist.
+		/// Takes ownership of the component types if they aren't owned by another group yet.
 		/// </summary>
-		/// <param name="id">ID tag of the component</param>
-		/// <returns>Reference to first found component with ID.</returns>
-		T& getComponentWithID(int id);
+		/// <returns>True if the group owns its types, false if another group owns one of them.</returns>
+		bool create();
 
-		/// <summary>
-		/// Returns reference to component at index of id. 
-		/// Will result in undefined behaviour if component does not exist.
-		/// </summary>
-		/// <param name="id">ID tag of component.</param>
-		/// <param name="index">Index of component to id.</param>
-		/// <returns>Reference to component at index with id.</returns>
-		T& getComponentWithIDAtIndex(int id, int index);
+		bool isOwning();
 
-		/// <summary>
-		/// Reserves sparse id size. If u is smaller than sparse capacity
-		/// this does nothing.
-		/// </summary>
-		/// <param name="u">Reserve size you wise to set sparse to.</param>
-		void reserveIDCapacity(int u);
+		int size();
 
-		/// <summary>
-		/// Reserve the size of dense list capacity. If u is smaller than current
-		/// capacity this does nothing.
-		/// </summary>
-		/// <param name="u">Reserve size you wish to set dense list as.</param>
-		void reserveComponentCapacity(int u);
+		template<class T>
+		typename SparseSet<T>::pointer data();
 
-		/// <summary>
-		/// Returns the amount of components with a given id.
-		/// </summary>
-		/// <param name="id">ID tag of components</param>
-		/// <returns>Amount of components with a given id.</returns>
-		int getNumberOfComponentsWithID(int id);
+		template<class Function>
+		void each(Function& function);
 
-		/// <summary>
-		/// Returns the number of components in use by dense pool not including
-		/// pooled components.
-		/// </summary>
-		/// <returns>Amount of active/used components.</returns>
-		int getNumberOfActiveComponents();
+	private:
+		Registry& registry;
+		std::tuple<SparseSet<Owned>&...> sets;
+		int groupSize = 0;
+		bool owning = false;
 
-		/// <summary>
-		/// Returns id of the system in use.
-		/// </summary>
-		/// <returns>System id.</returns>
-		int getSystemID() override;
+		// First owned type, used to find the id at a position.
+		typedef SparseSet<typename std::tuple_element<0, std::tuple<Owned...>>::type> Driver;
 
-		/// <summary>
-		/// Returns a reference to dense list of components both used and pooled.
-		/// </summary>
-		/// <returns>Vector reference to dense list of all components.</returns>
-		std::vector<T>& getDenseList();
+		template<class T>
+		SparseSet<T>& set();
 
-		/// <summary>
-		/// Update loop of components in entity manager.
-		/// </summary>
-		void update() override;
+		Driver& driver();
 
 		/// <summary>
-		/// Set whether you would like the system to run update on each
-		/// component or not. For systems that have no update
-		/// logic it's best to set this to false.
+		/// Returns true if id has an active component of every owned type.
 		/// </summary>
-		/// <param name="allow">True allows update, false skips update.</param>
-		void setCanUpdate(bool allow);
+		bool hasAll(int id);
 
-	protected:
-		static SparseSet<T> entityManager;
+		void changed(int id);
 
-	private:
-		static int systemID;
-		static bool allowUpdate;
+		int removing(int id, int position);
+
+		void cleared();
 
 		/// <summary>
-		/// Returns the highest id in use by the system.
+		/// Packs every entity that has all owned types from scratch.
 		/// </summary>
-		/// <returns>Returns the highest id in use by the system.</returns>
-		int highestIDUsed() override;
-	};
+		void pack();
 
-	template<class T>
-	SparseSet<T> System<T>::entityManager = SparseSet<T>();
+		static void changedHook(GroupHooks& group, int id);
 
-	template<class T>
-	int System<T>::systemID = -1;
+		static int removingHook(GroupHooks& group, int id, int position);
 
-	template<class T>
-	bool System<T>::allowUpdate = true;
+		static void clearedHook(GroupHooks& group);
 
-	template<class T>
-	System<T>::System()
+		static void restoredHook(GroupHooks& group);
+
+		template<size_t I, class Function, class... References>
+		void invoke(Function& function, int id, int position, References&... references);
+	};
+
+	template<class... Owned>
+	inline GroupState<Owned...>::GroupState(Registry& registry)
+		: GroupHooks{ &GroupState::changedHook, &GroupState::removingHook, &GroupState::clearedHook, &GroupState::restoredHook },
+		registry(registry), sets(registry.getSparseSet<Owned>()...)
 	{
-		if (systemID != -1)
-		{
-			return;
-		}
-		systemID = decs::World::createNewSystemID();
-		decs::World::addSystem(*this);
 
 	}
 
-	template<class T>
-	void System<T>::update()
+	template<class... Owned>
+	inline int GroupState<Owned...>::groupID()
 	{
-		if (!allowUpdate)
-		{
-			return;
-		}
-		entityManager.runUpdate();
+		static const int id = Registry::createNewGroupID();
+		return id;
 	}
 
-	template<class T>
-	int System<T>::highestIDUsed()
+	template<class... Owned>
+	inline bool GroupState<Owned...>::create()
 	{
-		return entityManager.numberOfIDs();
+		if (owning)
+		{
+			return true;
+		}
+		bool available = ((set<Owned>().owningGroup == nullptr) && ...);
+		if (!available)
+		{
+			return false;
+		}
+		((set<Owned>().owningGroup = this), ...);
+		owning = true;
+		pack();
+		return true;
 	}
 
-	template<class T>
-	void System<T>::setCanUpdate(bool allow)
+	template<class... Owned>
+	inline bool GroupState<Owned...>::isOwning()
 	{
-		allowUpdate = allow;;
+		return owning;
 	}
 
-	template<class T>
-	void System<T>::addComponentWithID(int id)
+	template<class... Owned>
+	inline int GroupState<Owned...>::size()
 	{
-		entityManager.insert(id);
+		return groupSize;
 	}
 
+	template<class... Owned>
 	template<class T>
-	inline void System<T>::addComponentValuesWithID(int id, T& copy)
+	inline typename SparseSet<T>::pointer GroupState<Owned...>::data()
 	{
-		entityManager.insertCopy(id, copy);
+		return set<T>().dense.data();
 	}
 
+	template<class... Owned>
 	template<class T>
-	inline void System<T>::emplaceComponentWithID(int id, T&& emplaced)
+	inline SparseSet<T>& GroupState<Owned...>::set()
 	{
-		entityManager.emplace(id, emplaced);
+		return std::get<SparseSet<T>&>(sets);
 	}
 
-	template<class T>
-	void System<T>::removeComponentWithID(int id)
+	template<class... Owned>
+	inline typename GroupState<Owned...>::Driver& GroupState<Owned...>::driver()
 	{
-		entityManager.removeWithID(id);
+		return std::get<0>(sets);
 	}
 
-	template<class T>
-	inline void System<T>::removeComponentWithIDAtIndex(int id, int index)
+	template<class... Owned>
+	inline bool GroupState<Owned...>::hasAll(int id)
 	{
-		entityManager.removeWithIDAtIndex(id, index);
+		return ((id < set<Owned>().capacity_sparse_vector && set<Owned>().sparse.contains(id)
+			&& set<Owned>().sparse.first(id) < set<Owned>().size_active_range) && ...);
 	}
 
-	template<class T>
-	bool System<T>::removeAllComponentsWithID(int id)
+	template<class... Owned>
+	inline void GroupState<Owned...>::changed(int id)
 	{
-		return entityManager.removeAllWithID(id);
+		if (!hasAll(id))
+		{
+			return;
+		}
+		// Grouped components are always the first component of their id.
+		if (driver().sparse.first(id) < groupSize)
+		{
+			return;
+		}
+		(set<Owned>().swapPositions(set<Owned>().sparse.first(id), groupSize), ...);
+		++groupSize;
 	}
 
-	template<class T>
-	void System<T>::destroyComponentWithID(int id)
+	template<class... Owned>
+	inline int GroupState<Owned...>::removing(int id, int position)
 	{
-		entityManager.eraseWithID(id);
+		if (position >= groupSize)
+		{
+			return position;
+		}
+		--groupSize;
+		(set<Owned>().swapPositions(position, groupSize), ...);
+		return groupSize;
 	}
 
-	template<class T>
-	inline void System<T>::destroyComponentWithIDAtIndex(int id, int index)
+	template<class... Owned>
+	inline void GroupState<Owned...>::cleared()
 	{
-		entityManager.eraseWithIDAtIndex(id, index);
+		groupSize = 0;
 	}
 
-	template<class T>
-	bool System<T>::destroyAllComponentsWithID(int id)
+	template<class... Owned>
+	inline void GroupState<Owned...>::pack()
 	{
-		return entityManager.eraseAllWithID(id);
+		if (!owning)
+		{
+			return;
+		}
+		// Pack existing entities. Anything swapped back past position was already checked.
+		groupSize = 0;
+		for (int position = 0; position < driver().size_dense_vector; position++)
+		{
+			changed(belongsToIDAt(driver().dense, position));
+		}
 	}
 
-	template<class T>
-	inline void System<T>::replaceComponentWithID(int id, T& replacement)
+	template<class... Owned>
+	inline void GroupState<Owned...>::changedHook(GroupHooks& group, int id)
 	{
-		entityManager.replace(id, replacement);
+		static_cast<GroupState&>(group).changed(id);
 	}
 
-	template<class T>
-	inline void System<T>::replaceComponentWithIDAtIndex(int id, int index, T& replacement)
+	template<class... Owned>
+	inline int GroupState<Owned...>::removingHook(GroupHooks& group, int id, int position)
 	{
-		entityManager.replace(id, index, replacement);
+		return static_cast<GroupState&>(group).removing(id, position);
 	}
 
-	template<class T>
-	inline void System<T>::clear()
+	template<class... Owned>
+	inline void GroupState<Owned...>::clearedHook(GroupHooks& group)
 	{
-		entityManager.clear();
+		static_cast<GroupState&>(group).cleared();
 	}
 
-	template<class T>
-	bool System<T>::hasComponentWithID(int id)
+	template<class... Owned>
+	inline void GroupState<Owned...>::restoredHook(GroupHooks& group)
 	{
-		return entityManager.has(id);
+		static_cast<GroupState&>(group).pack();
 	}
 
-	template<class T>
-	T* System<T>::getPtrComponentWithID(int id)
+	template<class... Owned>
+	template<class Function>
+	inline void GroupState<Owned...>::each(Function& function)
 	{
-		return entityManager.ptrGet(id);
+		if (!owning)
+		{
+			View<Owned...>(registry).each(function);
+			return;
+		}
+		for (int position = 0; position < groupSize; position++)
+		{
+			invoke<0>(function, belongsToIDAt(driver().dense, position), position);
+		}
 	}
 
-	template<class T>
-	T* System<T>::getPtrComponentWithIDAtIndex(int id, int index)
+	template<class... Owned>
+	template<size_t I, class Function, class... References>
+	inline void GroupState<Owned...>::invoke(Function& function, int id, int position, References&... references)
 	{
-		return entityManager.ptrGetAtIndex(id, index);
+		if constexpr (I == sizeof...(Owned))
+		{
+			function(id, references...);
+		}
+		else
+		{
+			// Binding to auto&& keeps SoAStorage references alive until function returns.
+			auto&& component = std::get<I>(sets).dense[position];
+			invoke<I + 1>(function, id, position, references..., component);
+		}
 	}
 
-	template<class T>
-	T& System<T>::getComponentWithID(int id)
+	/// <summary>
+	/// Owning group of component types. Entities that have an active component of every type are kept packed
+	/// at the front of each owned dense list in the same order, so position i of every list belongs to
+	/// the same entity for i below size(). Joined loops over the group are a lockstep walk over
+	/// the dense lists, and Views over the owned types find every grouped entity by position.
+	/// 
+	/// A type can only be owned by one group per Registry. Grouping is kept up to date on every insert and
+	/// remove, which costs a few swaps when an entity joins or leaves the group.
+	/// Reordering the dense lists of owned types by hand breaks the packing.
+	/// 
+	/// A Group is a handle to the GroupState of one Registry, so it can be constructed wherever it is needed.
+	/// </summary>
+	/// <typeparam name="Owned">Component types owned by the group.</typeparam>
+	template<class... Owned>
+	class Group
 	{
-		return entityManager.get(id);
-	}
+		static_assert(sizeof...(Owned) > 1, "Group needs at least two component types");
 
-	template<class T>
-	T& System<T>::getComponentWithIDAtIndex(int id, int index)
+	public:
+		/// <summary>
+		/// Takes ownership of the component types in the registry bound to the calling thread
+		/// and packs the entities that already have all of them.
+		/// </summary>
+		Group();
+
+		/// <summary>
+		/// Takes ownership of the component types in registry and packs the entities that already have all of them.
+		/// </summary>
+		/// <param name="registry">Registry that owns the components.</param>
+		explicit Group(Registry& registry);
+
+		/// <summary>
+		/// Takes ownership of the component types if they aren't owned by another group yet.
+		/// Called by the constructor.
+		/// </summary>
+		/// <returns>True if the group owns its types, false if another group owns one of them.</returns>
+		bool create();
+
+		/// <summary>
+		/// Returns whether the group owns its types and keeps them packed.
+		/// </summary>
+		bool isOwning();
+
+		/// <summary>
+		/// Returns the number of entities in the group.
+		/// </summary>
+		int size();
+
+		/// <summary>
+		/// Returns the dense list data of an owned type. Its first size() elements are the group.
+		/// </summary>
+		template<class T>
+		typename SparseSet<T>::pointer data();
+
+		/// <summary>
+		/// Calls function(id, components...) for every entity in the group.
+		/// Falls back to a View if the group doesn't own its types.
+		/// </summary>
+		/// <param name="function">Called for every entity in the group.</param>
+		template<class Function>
+		void each(Function function);
+
+	private:
+		GroupState<Owned...>& state;
+	};
+
+	template<class... Owned>
+	inline Group<Owned...>::Group()
+		: Group(Registry::current())
 	{
-		return entityManager.getAtIndex(id, index);
+
 	}
 
-	template<class T>
-	std::vector<T>& System<T>::getDenseList()
+	template<class... Owned>
+	inline Group<Owned...>::Group(Registry& registry)
+		: state(registry.getGroupState<Owned...>())
 	{
-		return entityManager.getDenseList();
+		create();
 	}
 
-	template<class T>
-	inline void System<T>::reserveIDCapacity(int u)
+	template<class... Owned>
+	inline bool Group<Owned...>::create()
 	{
-		entityManager.reserveIDCapacity(u);
+		return state.create();
 	}
 
-	template<class T>
-	inline void System<T>::reserveComponentCapacity(int u)
+	template<class... Owned>
+	inline bool Group<Owned...>::isOwning()
 	{
-		entityManager.reserveComponentCapacity(u);
+		return state.isOwning();
 	}
 
-	template<class T>
-	int System<T>::getNumberOfActiveComponents()
+	template<class... Owned>
+	inline int Group<Owned...>::size()
 	{
-		return entityManager.getNumberOfActiveComponents();
+		return state.size();
 	}
 
+	template<class... Owned>
 	template<class T>
-	int System<T>::getNumberOfComponentsWithID(int id)
+	inline typename SparseSet<T>::pointer Group<Owned...>::data()
 	{
-		return entityManager.numberOfComponentsWithID(id);
+		static_assert(std::disjunction<std::is_same<T, Owned>...>::value, "T is not owned by this Group");
+		return state.template data<T>();
 	}
 
-	template<class T>
-	int System<T>::getSystemID()
+	template<class... Owned>
+	template<class Function>
+	inline void Group<Owned...>::each(Function function)
 	{
-		return systemID;
+		state.each(function);
 	}
-} // End System<T>
+} // End Group
 
 namespace decs
 {
 	/// <summary>
-	/// This is an inherited class to be used by all Components.
+	/// Data shared by every component regardless of whether it uses virtual or static dispatch.
+	/// Do not inherit from this directly, inherit from Component or PodComponent instead.
 	/// </summary>
-	class Component
+	class ComponentBase
 	{
 	public:
-		Component();
-		Component(const Component& c);
-
-		virtual ~Component();
-
-		/// <summary>
-		/// Called on construction of new component or when reused 
-		/// from the pool. 
-		/// Default implementation does nothing.
-		/// </summary>
-		virtual void initialise();
-
 		/// <summary>
 		/// Get the entity that the current component belongs to
 		/// </summary>
 		/// <returns>ID tag of component</returns>
-		int belongsToID();
+		int belongsToID() const;
 
 		/// <summary>
 		/// Set the Id tag of component. This is called automatically 
@@ -1528,23 +9180,80 @@ namespace decs
 		void setBelongsToID(int id);
 
 		/// <summary>
-		/// Set whether to component is currently active. If this is 
-		/// set to false the buil in update will skip it on 
-		/// each update cycle until it is turned back on again.
-		/// 
-		/// Is automatically set to true on construction or when 
-		/// recycled from a pool.
+		/// Returns whether the component is active or not.
+		/// Change it with System<T>::setActive.
+		/// </summary>
+		/// <returns>Returns whether the component is active 
+		/// or not.</returns>
+		bool isActive() const;
+
+	protected:
+		int belongsTo = -1;
+		bool activeSelf = true;
+
+	private:
+		template<class T>
+		friend class SparseSet;
+
+		template<class T, auto... Members>
+		friend class SoAStorage;
+
+		template<class T>
+		friend bool readElement(std::istream& in, T& component);
+
+		template<class T>
+		friend bool hasValidFlags(const T* components, size_t count);
+
+		/// <summary>
+		/// Sets the flag only. Update skips components by their position, so the flag of a stored
+		/// component is changed by its SparseSet, which moves it across the active range with it.
+		/// Is automatically set to true on construction or when recycled from a pool.
 		/// </summary>
 		/// <param name="active">Set whether component is active 
 		/// or not.</param>
 		void setActive(bool active);
+	};
+
+	inline int ComponentBase::belongsToID() const
+	{
+		return belongsTo;
+	}
+
+	inline void ComponentBase::setBelongsToID(int id)
+	{
+		belongsTo = id;
+	}
+
+	inline void ComponentBase::setActive(bool active)
+	{
+		activeSelf = active;
+	}
+
+	inline bool ComponentBase::isActive() const
+	{
+		return activeSelf;
+	}
+} // End ComponentBase
+
+namespace decs
+{
+	/// <summary>
+	/// This is an inherited class to be used by all Components.
+	/// </summary>
+	class Component : public ComponentBase
+	{
+	public:
+		Component();
+		Component(const Component& c);
+
+		virtual ~Component();
 
 		/// <summary>
-		/// Returns whether the component is active or not.
+		/// Called on construction of new component or when reused 
+		/// from the pool. 
+		/// Default implementation does nothing.
 		/// </summary>
-		/// <returns>Returns whether the component is active 
-		/// or not.</returns>
-		bool isActive();
+		virtual void initialise();
 
 		/// <summary>
 		/// Update method of component. Can be overrided for 
@@ -1552,9 +9261,6 @@ namespace decs
 		/// Does nothing otherwise. 
 		/// </summary>
 		virtual void update();
-	protected:
-		int belongsTo = -1;
-		bool activeSelf = true;
 	};
 
 	inline Component::Component()
@@ -1578,28 +9284,50 @@ namespace decs
 
 	}
 
-	inline int Component::belongsToID()
-	{
-		return belongsTo;
-	}
-
 	inline void Component::update()
 	{
 		// Does nothing if not implemented
 	}
+} // End Component
 
-	inline void Component::setBelongsToID(int id)
+namespace decs
+{
+	/// <summary>
+	/// Alternative to Component for components that do not need virtual functions.
+	/// Inherit as class MyComponent : public decs::PodComponent<MyComponent>.
+	/// 
+	/// initialise and update are hidden rather than overridden, so do not mark them
+	/// override or virtual. System<T> calls them through T directly which lets the
+	/// update loop inline and removes the vtable pointer from every component.
+	/// </summary>
+	/// <typeparam name="T">The class/struct inheriting from PodComponent.</typeparam>
+	template<class T>
+	class PodComponent : public ComponentBase
 	{
-		belongsTo = id;
-	}
+	public:
+		/// <summary>
+		/// Called on construction of new component or when reused 
+		/// from the pool. Hide with a method of the same name for custom logic.
+		/// Default implementation does nothing.
+		/// </summary>
+		void initialise();
+
+		/// <summary>
+		/// Update method of component. Hide with a method of the same
+		/// name for custom logic. Does nothing otherwise.
+		/// </summary>
+		void update();
+	};
 
-	inline void Component::setActive(bool active)
+	template<class T>
+	inline void PodComponent<T>::initialise()
 	{
-		activeSelf = active;
+
 	}
 
-	inline bool Component::isActive()
+	template<class T>
+	inline void PodComponent<T>::update()
 	{
-		return activeSelf;
+		// Does nothing if not implemented
 	}
-} // End Component
+} // End PodComponent